@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <sstream>
@@ -13,6 +14,36 @@
 #include <chrono>
 #include <cctype>
 #include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <atomic>
+#include <deque>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <cstring>
+#include <filesystem>
+#include <cmath>
+#include <bitset>
+#include <iomanip>
+#include <limits>
+#include <charconv>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
 
 using namespace std;
 
@@ -30,352 +61,4383 @@ static inline string toUpper(string s) {
     return s;
 }
 
-//model
+// string_view versions used by the mapped loader (no temporaries until the final copy)
+static inline string_view trimView(string_view s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == string_view::npos) return {};
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static inline string upperCopy(string_view s) {
+    string out(s.size(), '\0');
+    transform(s.begin(), s.end(), out.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+    return out;
+}
+
+// uppercases into a reused buffer (no allocation once the buffer has grown)
+static inline string_view upperInto(string_view s, string& buf) {
+    buf.resize(s.size());
+    transform(s.begin(), s.end(), buf.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+    return buf;
+}
+
+// Case-insensitive code matching, done inside the lookups so a query never needs an
+// uppercase copy. Only ASCII letters fold; stored codes are uppercase already, so the
+// folded order of stored codes is their plain byte order.
+static inline unsigned char foldCode(unsigned char c) { return (unsigned)(c - 'a') < 26u ? (unsigned char)(c - 32) : c; }
+
+static inline int compareCode(string_view a, string_view b) {
+    const size_t n = min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char x = foldCode(a[i]), y = foldCode(b[i]);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return a.size() < b.size() ? -1 : a.size() > b.size();
+}
+
+// hash and equality for code-keyed maps; transparent, so any string-like key can probe
+struct CodeHash {
+    using is_transparent = void;
+    size_t operator()(string_view s) const noexcept {
+        uint64_t h = 14695981039346656037ull;       // FNV-1a over the folded bytes
+        for (unsigned char c : s) h = (h ^ foldCode(c)) * 1099511628211ull;
+        return (size_t)(h ^ (h >> 32));
+    }
+};
+struct CodeEqual {
+    using is_transparent = void;
+    bool operator()(string_view a, string_view b) const noexcept {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) if (foldCode(a[i]) != foldCode(b[i])) return false;
+        return true;
+    }
+};
+
+// read-only memory mapping of an input file (whole-file read fallback on Windows)
+class MappedFile {
+    const char* ptr = nullptr;
+    size_t len = 0;
+    bool opened = false;
+#ifdef _WIN32
+    vector<char> buf;
+#endif
 
-class Course {
 public:
-    string courseNumber;               // ex "CSCI300"
-    string courseTitle;                // ex "Data Structures"
-    vector<string> prerequisites;      // list of course numbers
+    explicit MappedFile(const string& path) {
+#ifdef _WIN32
+        ifstream f(path, ios::binary);
+        if (!f) return;
+        buf.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+        ptr = buf.data(); len = buf.size(); opened = true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0) {
+            len = (size_t)st.st_size;
+            opened = true;
+            if (len > 0) {
+                void* m = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (m == MAP_FAILED) { opened = false; len = 0; }
+                else {
+                    ptr = (const char*)m;
+                    ::madvise(m, len, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        ::close(fd);
+#endif
+    }
+    ~MappedFile() {
+#ifndef _WIN32
+        if (ptr) ::munmap((void*)ptr, len);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
 
-    Course() {}
-    Course(string number, string title, const vector<string>& prereqs)
-        : courseNumber(std::move(number)), courseTitle(std::move(title)), prerequisites(prereqs) {}
+    bool ok() const { return opened; }
+    string_view view() const { return string_view(ptr, len); }
 };
 
-// unbalanced binary search tree
+// thread pool (fixed workers, FIFO task queue)
 
-struct TreeNode {
-    Course course;
-    TreeNode* left;
-    TreeNode* right;
-    explicit TreeNode(const Course& c) : course(c), left(nullptr), right(nullptr) {}
+class ThreadPool {
+    vector<thread> workers;
+    queue<function<void()>> tasks;
+    mutex m;
+    condition_variable cv;
+    bool stopping = false;
+
+public:
+    explicit ThreadPool(unsigned n) {
+        for (unsigned i = 0; i < max(1u, n); ++i) {
+            workers.emplace_back([this] {
+                while (true) {
+                    function<void()> task;
+                    {
+                        unique_lock<mutex> lk(m);
+                        cv.wait(lk, [this] { return stopping || !tasks.empty(); });
+                        if (stopping && tasks.empty()) return;
+                        task = std::move(tasks.front());
+                        tasks.pop();
+                    }
+                    task();
+                }
+                });
+        }
+    }
+    ~ThreadPool() {
+        { lock_guard<mutex> lk(m); stopping = true; }
+        cv.notify_all();
+        for (auto& w : workers) w.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers.size(); }
+
+    template <class F>
+    future<void> submit(F f) {
+        auto task = make_shared<packaged_task<void()>>(std::move(f));
+        future<void> fut = task->get_future();
+        { lock_guard<mutex> lk(m); tasks.emplace([task] { (*task)(); }); }
+        cv.notify_one();
+        return fut;
+    }
 };
 
-class BinarySearchTree {
-    TreeNode* root = nullptr;
+// runs independent jobs on the pool (inline when there is no pool) and waits for all of them
+static void runAll(ThreadPool* pool, vector<function<void()>> jobs) {
+    if (!pool) { for (auto& j : jobs) j(); return; }
+    vector<future<void>> pending;
+    pending.reserve(jobs.size());
+    for (auto& j : jobs) pending.push_back(pool->submit(std::move(j)));
+    for (auto& f : pending) f.get();
+}
 
-    static TreeNode* insertRec(TreeNode* node, const Course& c) {
-        if (!node) return new TreeNode(c);
-        if (c.courseNumber < node->course.courseNumber) node->left = insertRec(node->left, c);
-        else node->right = insertRec(node->right, c);
-        return node;
+// load instrumentation
+
+// Allocation counters behind the global operator new below. They only count while a
+// LoadStats is recording; otherwise every allocation pays one relaxed load and a branch.
+struct AllocCount { uint64_t count = 0, bytes = 0; };
+static atomic<int> allocRecorders{ 0 };
+static atomic<uint64_t> allocTotal{ 0 }, allocTotalBytes{ 0 };
+static thread_local AllocCount threadAllocs;        // this thread's share, for jobs running side by side
+
+static void* countedMalloc(size_t n) noexcept {
+    if (allocRecorders.load(memory_order_relaxed)) {
+        allocTotal.fetch_add(1, memory_order_relaxed);
+        allocTotalBytes.fetch_add(n, memory_order_relaxed);
+        threadAllocs.count++;
+        threadAllocs.bytes += n;
     }
+    return malloc(n ? n : 1);
+}
 
-    static TreeNode* searchRec(TreeNode* node, const string& key) {
-        if (!node || node->course.courseNumber == key) return node;
-        return (key < node->course.courseNumber)
-            ? searchRec(node->left, key)
-            : searchRec(node->right, key);
+// Every plain, array and nothrow form is replaced, so no allocation reaches the runtime's
+// own operator new (under ASan, that one and free() below would not match).
+void* operator new(size_t n) {
+    if (void* p = countedMalloc(n)) return p;
+    throw bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void* operator new(size_t n, const nothrow_t&) noexcept { return countedMalloc(n); }
+void* operator new[](size_t n, const nothrow_t&) noexcept { return countedMalloc(n); }
+// The replacement new above is malloc, so free() is the matching release. GCC cannot
+// tell once this is inlined into a delete-expression and warns about a mismatch.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Wall-clock time, allocations and bytes allocated per phase of the last recorded load.
+// A load has about a dozen phases, and each costs one branch while recording is off.
+class LoadStats {
+public:
+    struct Phase {
+        string name;
+        double ms = 0;
+        uint64_t allocs = 0, bytes = 0;
+    };
+    bool enabled = false;                           // record the loads that follow
+    vector<Phase> phases;                           // in the order they finished
+
+    // Times the enclosing block. A threadOnly phase counts just the allocations of the
+    // thread it runs on (a build job next to other jobs); otherwise every thread counts
+    // (a phase that fans out to the pool).
+    class Scope {
+        LoadStats* stats;
+        const char* name;
+        bool threadOnly;
+        chrono::steady_clock::time_point t0;
+        AllocCount a0;
+
+        AllocCount now() const {
+            if (threadOnly) return threadAllocs;
+            return { allocTotal.load(memory_order_relaxed), allocTotalBytes.load(memory_order_relaxed) };
+        }
+
+    public:
+        Scope(LoadStats& s, const char* phase, bool threadOnly = false)
+            : stats(s.enabled ? &s : nullptr), name(phase), threadOnly(threadOnly) {
+            if (!stats) return;
+            a0 = now();
+            t0 = chrono::steady_clock::now();
+        }
+        ~Scope() { done(); }
+
+        // ends this phase early, or ends it and starts the next one right away
+        void done() {
+            if (!stats || !name) return;
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            AllocCount a = now();
+            stats->add({ name, ms, a.count - a0.count, a.bytes - a0.bytes });
+            name = nullptr;
+        }
+        void next(const char* phase) {
+            if (!stats) return;
+            done();
+            name = phase;
+            a0 = now();
+            t0 = chrono::steady_clock::now();
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // brackets one load: clears the last one's phases and turns allocation counting on
+    void begin() {
+        phases.clear();                             // never show phases of an older load
+        if (!enabled) return;
+        allocRecorders.fetch_add(1, memory_order_relaxed);
+        recording = true;
+    }
+    void end() {
+        if (!recording) return;
+        allocRecorders.fetch_sub(1, memory_order_relaxed);
+        recording = false;
     }
 
-    static void inOrderRec(TreeNode* node) {
-        if (!node) return;
-        inOrderRec(node->left);
-        cout << node->course.courseNumber << ", " << node->course.courseTitle << '\n';
-        inOrderRec(node->right);
+private:
+    bool recording = false;
+    mutex m;                                        // build jobs finish concurrently
+
+    void add(Phase p) { lock_guard<mutex> lk(m); phases.push_back(std::move(p)); }
+};
+
+// approximate heap footprint of an unordered_map: the bucket array plus one node per
+// element (next pointer, value, cached hash)
+template <class Map>
+static size_t hashTableBytes(const Map& m) {
+    return m.bucket_count() * sizeof(void*)
+        + m.size() * (sizeof(void*) + sizeof(typename Map::value_type) + sizeof(size_t));
+}
+
+// flat arrays
+
+// Contiguous read-only array that either owns its elements or views memory owned by
+// someone else (a mapped snapshot). Readers cannot tell which.
+template <class T>
+class FlatArray {
+    vector<T> own;
+    const T* ptr = nullptr;
+    size_t len = 0;
+
+public:
+    FlatArray() = default;
+    FlatArray(vector<T> v) : own(std::move(v)), ptr(own.data()), len(own.size()) {}
+    FlatArray(const FlatArray& o) : own(o.own), ptr(o.ptr == o.own.data() ? own.data() : o.ptr), len(o.len) {}
+    FlatArray(FlatArray&& o) noexcept : own(std::move(o.own)), ptr(o.ptr), len(o.len) { o.ptr = nullptr; o.len = 0; }
+    FlatArray& operator=(FlatArray o) noexcept {
+        own.swap(o.own); swap(ptr, o.ptr); swap(len, o.len);
+        return *this;
     }
 
-    static void destroy(TreeNode* node) {
-        if (!node) return;
-        destroy(node->left); destroy(node->right); delete node;
+    void borrow(const T* p, size_t n) { vector<T>().swap(own); ptr = p; len = n; }
+    void clear() { vector<T>().swap(own); ptr = nullptr; len = 0; }
+
+    const T* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    size_t heapBytes() const { return own.capacity() * sizeof(T); } // 0 while borrowing
+    const T& operator[](size_t i) const { return ptr[i]; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + len; }
+};
+
+// interned course codes
+
+// Each distinct course code gets a dense uint32_t id the first time it is seen. Courses
+// are interned before prerequisites, so ids [0, courseCount) are courses and anything
+// above that is a prerequisite code with no course row.
+class CodeTable {
+    static constexpr size_t BLOCK = 64 * 1024;
+    vector<unique_ptr<char[]>> blocks;          // text of codes interned from CSV; blocks never move
+    char* free = nullptr;                       // unused tail of blocks.back()
+    size_t left = 0;
+    size_t blockBytes = 0;
+    vector<string_view> names;                  // index = id (into blocks, or into a snapshot)
+    unordered_map<string_view, uint32_t> ids;   // built lazily after adopt()
+
+    string_view store(string_view s) {
+        if (!free || s.size() > left) {
+            size_t size = max(BLOCK, s.size());
+            blocks.emplace_back(new char[size]);
+            blockBytes += size;
+            free = blocks.back().get();
+            left = size;
+        }
+        memcpy(free, s.data(), s.size());
+        string_view v(free, s.size());
+        free += s.size();
+        left -= s.size();
+        return v;
+    }
+
+    void index() {
+        if (ids.size() == names.size()) return;
+        ids.clear();
+        ids.reserve(names.size());
+        for (uint32_t i = 0; i < names.size(); ++i) ids.emplace(names[i], i);
     }
 
 public:
-    ~BinarySearchTree() { destroy(root); }
-    void insert(const Course& c) { root = insertRec(root, c); }
-    const Course* search(const string& key) const {
-        TreeNode* n = searchRec(root, key);
-        return n ? &n->course : nullptr;
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    uint32_t intern(string_view code) {
+        index();
+        auto it = ids.find(code);
+        if (it != ids.end()) return it->second;
+        uint32_t id = (uint32_t)names.size();
+        names.push_back(store(code));
+        ids.emplace(names.back(), id);
+        return id;
     }
-    void printInOrder() const {
-        cout << "Here is a sample schedule:\n\n";
-        inOrderRec(root);
+    // id of an interned code, or npos; never adds one
+    uint32_t find(string_view code) {
+        index();
+        auto it = ids.find(code);
+        return it == ids.end() ? npos : it->second;
+    }
+    // takes over names stored elsewhere (a mapped snapshot); the lookup map is only
+    // rebuilt if something is interned later
+    void adopt(vector<string_view> v) { clear(); names = std::move(v); }
+
+    string_view name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+    void reserve(size_t n) { ids.reserve(n); }
+    void clear() {
+        ids.clear();
+        names.clear();
+        blocks.clear();
+        free = nullptr;
+        left = blockBytes = 0;
+    }
+    // code text, views, and the lookup map
+    size_t memoryBytes() const { return blockBytes + names.capacity() * sizeof(string_view) + hashTableBytes(ids); }
+};
+
+// prerequisite graph (compressed sparse row)
+
+struct IdRange {
+    const uint32_t* b;
+    const uint32_t* e;
+    const uint32_t* begin() const { return b; }
+    const uint32_t* end() const { return e; }
+    size_t size() const { return (size_t)(e - b); }
+    bool empty() const { return b == e; }
+    uint32_t operator[](size_t i) const { return b[i]; }
+};
+
+// Neighbours of u are targets[offsets[u] .. offsets[u + 1]); two flat arrays for the
+// whole graph instead of one heap vector per vertex.
+struct CsrGraph {
+    FlatArray<uint32_t> offsets{ vector<uint32_t>{ 0 } }; // size nodes() + 1
+    FlatArray<uint32_t> targets;                          // size edges()
+
+    uint32_t nodes() const { return (uint32_t)offsets.size() - 1; }
+    size_t edges() const { return targets.size(); }
+    IdRange out(uint32_t u) const { return { targets.data() + offsets[u], targets.data() + offsets[u + 1] }; }
+    uint32_t degree(uint32_t u) const { return offsets[u + 1] - offsets[u]; }
+
+    // counting sort by source; edges keep their input order within each vertex
+    static CsrGraph build(uint32_t n, const vector<pair<uint32_t, uint32_t>>& edges) {
+        vector<uint32_t> offs((size_t)n + 1, 0), tgts(edges.size());
+        for (const auto& e : edges) offs[e.first + 1]++;
+        for (uint32_t u = 0; u < n; ++u) offs[u + 1] += offs[u];
+        vector<uint32_t> fill(offs.begin(), offs.end() - 1);
+        for (const auto& e : edges) tgts[fill[e.first]++] = e.second;
+        CsrGraph g;
+        g.offsets = std::move(offs);
+        g.targets = std::move(tgts);
+        return g;
+    }
+
+    CsrGraph reversed() const {
+        uint32_t n = nodes();
+        vector<uint32_t> offs((size_t)n + 1, 0), tgts(targets.size());
+        for (uint32_t v : targets) offs[v + 1]++;
+        for (uint32_t u = 0; u < n; ++u) offs[u + 1] += offs[u];
+        vector<uint32_t> fill(offs.begin(), offs.end() - 1);
+        for (uint32_t u = 0; u < n; ++u)
+            for (uint32_t v : out(u)) tgts[fill[v]++] = u;
+        CsrGraph r;
+        r.offsets = std::move(offs);
+        r.targets = std::move(tgts);
+        return r;
+    }
+
+    // views arrays that live elsewhere (a mapped snapshot)
+    void borrow(const uint32_t* offs, uint32_t n, const uint32_t* tgts, size_t m) {
+        offsets.borrow(offs, (size_t)n + 1);
+        targets.borrow(tgts, m);
+    }
+
+    size_t memoryBytes() const { return offsets.heapBytes() + targets.heapBytes(); }
+    void clear() { offsets = vector<uint32_t>{ 0 }; targets.clear(); }
+};
+
+// DFS cycle detection with an explicit stack of (vertex, next edge), so chain length is
+// not limited by the call stack. Returns the first cycle found as a vertex path following
+// the edges (path[i] -> path[i + 1], last -> first); empty when the graph is a DAG.
+static vector<uint32_t> csrFindCycle(const CsrGraph& g) {
+    enum State : uint8_t { UNVIS = 0, VISITING = 1, VISITED = 2 };
+    const uint32_t n = g.nodes();
+    vector<uint8_t> state(n, UNVIS);
+    vector<pair<uint32_t, uint32_t>> stack;           // vertex, offset of its next edge
+
+    for (uint32_t root = 0; root < n; ++root) {
+        if (state[root] != UNVIS) continue;
+        state[root] = VISITING;
+        stack.emplace_back(root, g.offsets[root]);
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            uint32_t u = top.first;
+            if (top.second == g.offsets[u + 1]) {
+                state[u] = VISITED;
+                stack.pop_back();
+                continue;
+            }
+            uint32_t v = g.targets[top.second++];
+            if (state[v] == VISITING) {                 // back-edge: v is on the stack
+                vector<uint32_t> path;
+                size_t i = stack.size();
+                while (stack[i - 1].first != v) --i;
+                for (--i; i < stack.size(); ++i) path.push_back(stack[i].first);
+                return path;
+            }
+            if (state[v] == UNVIS) {
+                state[v] = VISITING;
+                stack.emplace_back(v, g.offsets[v]);
+            }
+        }
+    }
+    return {};
+}
+
+static bool csrHasCycle(const CsrGraph& g) { return !csrFindCycle(g).empty(); }
+
+// Tarjan's strongly connected components, iterative, one linear pass. Only the cyclic
+// components are returned: every group of two or more vertices, plus self-loops.
+static vector<vector<uint32_t>> csrCyclicComponents(const CsrGraph& g) {
+    const uint32_t n = g.nodes();
+    const uint32_t UNSEEN = UINT32_MAX;
+    vector<uint32_t> index(n, UNSEEN), low(n, 0);
+    vector<uint8_t> onStack(n, 0);
+    vector<uint32_t> sccStack;
+    vector<pair<uint32_t, uint32_t>> call;            // vertex, offset of its next edge
+    vector<vector<uint32_t>> groups;
+    uint32_t next = 0;
+
+    for (uint32_t root = 0; root < n; ++root) {
+        if (index[root] != UNSEEN) continue;
+        index[root] = low[root] = next++;
+        sccStack.push_back(root); onStack[root] = 1;
+        call.emplace_back(root, g.offsets[root]);
+
+        while (!call.empty()) {
+            auto& top = call.back();
+            uint32_t u = top.first;
+            if (top.second < g.offsets[u + 1]) {
+                uint32_t v = g.targets[top.second++];
+                if (index[v] == UNSEEN) {
+                    index[v] = low[v] = next++;
+                    sccStack.push_back(v); onStack[v] = 1;
+                    call.emplace_back(v, g.offsets[v]);
+                }
+                else if (onStack[v]) {
+                    low[u] = min(low[u], index[v]);
+                }
+                continue;
+            }
+
+            call.pop_back();
+            if (!call.empty()) {
+                uint32_t parent = call.back().first;
+                low[parent] = min(low[parent], low[u]);
+            }
+            if (low[u] != index[u]) continue;
+
+            // u is the root of a component
+            vector<uint32_t> comp;
+            uint32_t w;
+            do {
+                w = sccStack.back(); sccStack.pop_back();
+                onStack[w] = 0;
+                comp.push_back(w);
+            } while (w != u);
+            bool selfLoop = comp.size() == 1 && find(g.out(u).begin(), g.out(u).end(), u) != g.out(u).end();
+            if (comp.size() > 1 || selfLoop) {
+                reverse(comp.begin(), comp.end());
+                groups.push_back(std::move(comp));
+            }
+        }
+    }
+    return groups;
+}
+
+// Kahn's algorithm; the vector doubles as the FIFO queue since every vertex is pushed once
+static vector<uint32_t> csrTopoOrder(const CsrGraph& g, bool& ok) {
+    const uint32_t n = g.nodes();
+    vector<uint32_t> indeg(n, 0);
+    for (uint32_t v : g.targets) indeg[v]++;
+
+    vector<uint32_t> order;
+    order.reserve(n);
+    for (uint32_t u = 0; u < n; ++u) if (indeg[u] == 0) order.push_back(u);
+    for (size_t head = 0; head < order.size(); ++head) {
+        for (uint32_t v : g.out(order[head])) {
+            if (--indeg[v] == 0) order.push_back(v);
+        }
+    }
+    ok = (order.size() == n);
+    return order;
+}
+
+// transitive prerequisites
+
+static inline uint32_t lowestBit(uint64_t b) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctzll(b);
+#else
+    uint32_t n = 0;
+    while (!(b & 1)) { b >>= 1; ++n; }
+    return n;
+#endif
+}
+
+static inline uint32_t bitCount(uint64_t b) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_popcountll(b);
+#else
+    uint32_t n = 0;
+    for (; b; b &= b - 1) ++n;
+    return n;
+#endif
+}
+
+// Bitset that stores only its non-zero 64-bit words (word index, bits), sorted by index.
+// A closure over a million courses that touches a few thousand of them stays small.
+struct SparseBits {
+    vector<uint32_t> words;
+    vector<uint64_t> bits;
+
+    bool test(uint32_t v) const {
+        auto it = lower_bound(words.begin(), words.end(), v >> 6);
+        return it != words.end() && *it == (v >> 6) && (bits[it - words.begin()] >> (v & 63) & 1);
+    }
+    size_t count() const {
+        size_t c = 0;
+        for (uint64_t b : bits) c += (size_t)bitset<64>(b).count();
+        return c;
+    }
+    size_t bytes() const { return words.capacity() * sizeof(uint32_t) + bits.capacity() * sizeof(uint64_t); }
+
+    template <class F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < words.size(); ++i)
+            for (uint64_t b = bits[i]; b; b &= b - 1) f(words[i] * 64 + lowestBit(b));
+    }
+};
+
+// Lazily memoized transitive closure over a course -> prerequisite graph. The first query
+// for a course is a BFS that stops at every course whose closure is already memoized and
+// ORs that set in, so overlapping queries share work; repeats are a lookup. Longest-chain
+// depth is memoized for every course the DFS passes. Not thread-safe (queries mutate).
+class PrereqClosure {
+public:
+    static constexpr uint32_t UNKNOWN = UINT32_MAX;
+
+    void reset(const CsrGraph* prereqGraph) {
+        g = prereqGraph;
+        const uint32_t n = g ? g->nodes() : 0;
+        memoSlot.assign(n, UNKNOWN);
+        depth.assign(n, UNKNOWN);
+        sets.clear();
+        scratch.assign(((size_t)n + 63) / 64, 0);
+        memoBytes = 0;
+        compRep.clear(); groups.clear(); groupOf.clear();
+        compsReady = false;
+    }
+
+    // every course reachable from v through one or more prerequisite edges; contains v
+    // itself only if v sits on a cycle
+    const SparseBits& closureOf(uint32_t v) {
+        if (memoSlot[v] != UNKNOWN) return sets[memoSlot[v]];
+        touched.clear();
+        queue.clear();
+        for (uint32_t p : g->out(v)) if (mark(p)) queue.push_back(p);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            uint32_t u = queue[head];
+            if (memoSlot[u] != UNKNOWN) {           // everything below u is already known
+                const SparseBits& s = sets[memoSlot[u]];
+                for (size_t i = 0; i < s.words.size(); ++i) {
+                    if (!scratch[s.words[i]]) touched.push_back(s.words[i]);
+                    scratch[s.words[i]] |= s.bits[i];
+                }
+                continue;
+            }
+            for (uint32_t p : g->out(u)) if (mark(p)) queue.push_back(p);
+        }
+
+        SparseBits out;
+        sort(touched.begin(), touched.end());
+        out.words = touched;
+        out.bits.reserve(touched.size());
+        for (uint32_t w : touched) { out.bits.push_back(scratch[w]); scratch[w] = 0; }
+
+        if (memoBytes + out.bytes() > memoBudget) { spill = std::move(out); return spill; }
+        memoBytes += out.bytes();
+        memoSlot[v] = (uint32_t)sets.size();
+        sets.push_back(std::move(out));
+        return sets.back();
+    }
+
+    // Courses in the longest prerequisite chain below v (0 = no prerequisites). On a
+    // cyclic graph chains are measured over the cyclic groups, each group counting once.
+    uint32_t depthOf(uint32_t v) {
+        while (!depthFrom(rep(v))) buildComponents();
+        return depth[rep(v)];
+    }
+
+    // closure as sorted ids plus depth, the shape the catalog and readers hand out
+    struct Chain {
+        vector<uint32_t> ids;
+        uint32_t depth = 0;
+        bool cyclic = false;                        // v is its own (indirect) prerequisite
+    };
+    Chain chain(uint32_t v) {
+        Chain out;
+        const SparseBits& s = closureOf(v);
+        out.ids.reserve(s.count());
+        s.forEach([&](uint32_t u) { out.ids.push_back(u); });
+        out.cyclic = s.test(v);
+        out.depth = depthOf(v);
+        return out;
+    }
+
+    size_t memoized() const { return sets.size(); }
+    size_t memoryBytes() const { return memoBytes; }
+    size_t memoBudget = (size_t)256 << 20;          // memoization stops past this; queries still work
+
+private:
+    const CsrGraph* g = nullptr;
+    vector<uint32_t> memoSlot;                      // course -> index into sets
+    vector<SparseBits> sets;
+    SparseBits spill;                               // last result that did not fit the budget
+    size_t memoBytes = 0;
+
+    vector<uint64_t> scratch;                       // dense BFS marks, all zero between queries
+    vector<uint32_t> touched, queue;
+
+    vector<uint32_t> depth;                         // per component representative
+    vector<uint32_t> compRep, groupOf;              // filled only once a cycle has been seen
+    vector<vector<uint32_t>> groups;
+    bool compsReady = false;
+
+    bool mark(uint32_t v) {
+        uint64_t& w = scratch[v >> 6];
+        const uint64_t bit = 1ull << (v & 63);
+        if (w & bit) return false;
+        if (!w) touched.push_back(v >> 6);
+        w |= bit;
+        return true;
+    }
+
+    uint32_t rep(uint32_t v) const { return compsReady ? compRep[v] : v; }
+
+    void buildComponents() {
+        const uint32_t n = g->nodes();
+        groups = csrCyclicComponents(*g);
+        compRep.resize(n);
+        groupOf.assign(n, UNKNOWN);
+        for (uint32_t v = 0; v < n; ++v) compRep[v] = v;
+        for (uint32_t i = 0; i < (uint32_t)groups.size(); ++i) {
+            for (uint32_t v : groups[i]) { compRep[v] = groups[i].front(); groupOf[v] = i; }
+        }
+        compsReady = true;
+        // depths finished so far belong to acyclic vertices and stay valid
+        for (auto& d : depth) if (d == VISITING) d = UNKNOWN;
+    }
+
+    // Iterative post-order DFS over components. Returns false if it meets a cycle before
+    // the components are known, so the caller can build them and retry.
+    static constexpr uint32_t VISITING = UINT32_MAX - 1;
+    bool depthFrom(uint32_t root) {
+        if (depth[root] != UNKNOWN) return true;
+        struct Frame { uint32_t rep, member, edge, best; };
+        vector<Frame> stack;
+        auto members = [&](uint32_t r) -> IdRange {
+            if (compsReady && groupOf[r] != UNKNOWN) {
+                const auto& grp = groups[groupOf[r]];
+                return { grp.data(), grp.data() + grp.size() };
+            }
+            return { nullptr, nullptr };
+        };
+        auto push = [&](uint32_t r) {
+            depth[r] = VISITING;
+            IdRange m = members(r);
+            uint32_t first = m.empty() ? r : m[0];
+            stack.push_back({ r, 0, g->offsets[first], 0 });
+        };
+        push(root);
+        while (!stack.empty()) {
+            Frame& f = stack.back();
+            IdRange m = members(f.rep);
+            uint32_t x = m.empty() ? f.rep : m[f.member];
+            if (f.edge == g->offsets[x + 1]) {
+                if (++f.member < m.size()) { f.edge = g->offsets[m[f.member]]; continue; }
+                uint32_t d = f.best;
+                depth[f.rep] = d;
+                stack.pop_back();
+                if (!stack.empty()) stack.back().best = max(stack.back().best, d + 1);
+                continue;
+            }
+            uint32_t r = rep(g->targets[f.edge++]);
+            if (r == f.rep) continue;               // edge inside a cyclic group
+            if (depth[r] == VISITING) {
+                for (const Frame& s : stack) depth[s.rep] = UNKNOWN;
+                return false;
+            }
+            if (depth[r] == UNKNOWN) push(r);
+            else f.best = max(f.best, depth[r] + 1);
+        }
+        return true;
+    }
+};
+
+// online topological order
+
+// Editable prerequisite graph (prereq -> dependent) that keeps a topological order up to
+// date one edge at a time (Pearce & Kelly). Inserting p -> c when c already comes after p
+// is O(1); otherwise only the vertices ordered between c and p are searched and
+// reshuffled, and finding p from c means the edge would close a cycle. If the graph it
+// starts from is already cyclic there is no order to keep, and each insert falls back to
+// a plain reachability search.
+class DynamicDag {
+public:
+    vector<vector<uint32_t>> out, in;               // dependents of u, prerequisites of u
+
+    void init(const CsrGraph& fwd, const CsrGraph& rev) {
+        const uint32_t n = fwd.nodes();
+        out.assign(n, {});
+        in.assign(n, {});
+        for (uint32_t u = 0; u < n; ++u) {
+            out[u].assign(fwd.out(u).begin(), fwd.out(u).end());
+            in[u].assign(rev.out(u).begin(), rev.out(u).end());
+        }
+        mark.assign(n, 0);
+        bool ok = false;
+        vector<uint32_t> order = csrTopoOrder(fwd, ok);
+        setOrder(ok ? std::move(order) : vector<uint32_t>());
+    }
+
+    // a fresh order from a full Kahn pass (empty = cyclic, none kept)
+    void setOrder(vector<uint32_t> order) {
+        ordered = !order.empty() || out.empty();
+        at = std::move(order);
+        ord.assign(out.size(), 0);
+        for (uint32_t i = 0; i < (uint32_t)at.size(); ++i) ord[at[i]] = i;
+    }
+
+    uint32_t nodes() const { return (uint32_t)out.size(); }
+    bool isOrdered() const { return ordered; }
+    const vector<uint32_t>& order() const { return at; }
+
+    void addVertex() {
+        out.emplace_back();
+        in.emplace_back();
+        mark.push_back(0);
+        ord.push_back((uint32_t)at.size());
+        at.push_back((uint32_t)out.size() - 1);
+    }
+
+    bool hasEdge(uint32_t p, uint32_t c) const { return find(out[p].begin(), out[p].end(), c) != out[p].end(); }
+
+    // adds p -> c unless it would close a cycle (returns false and leaves the graph as is)
+    bool addEdge(uint32_t p, uint32_t c) {
+        if (p == c) return false;
+        if (!ordered) {
+            if (reaches(c, p)) return false;
+        }
+        else if (ord[c] < ord[p]) {
+            const uint32_t lb = ord[c], ub = ord[p];
+            deltaF.clear(); deltaB.clear();
+            bool cycle = !collect(c, ub, true, deltaF, p);
+            if (!cycle) collect(p, lb, false, deltaB, UINT32_MAX);
+            for (uint32_t v : deltaF) mark[v] = 0;
+            for (uint32_t v : deltaB) mark[v] = 0;
+            if (cycle) return false;
+            reorder();
+        }
+        out[p].push_back(c);
+        in[c].push_back(p);
+        return true;
+    }
+
+    // removing an edge never invalidates a topological order
+    bool removeEdge(uint32_t p, uint32_t c) {
+        auto it = find(out[p].begin(), out[p].end(), c);
+        if (it == out[p].end()) return false;
+        out[p].erase(it);
+        in[c].erase(find(in[c].begin(), in[c].end(), p));
+        return true;
+    }
+
+    // the current edges as CSR (prereq -> dependent)
+    CsrGraph toCsr() const {
+        const uint32_t n = nodes();
+        vector<uint32_t> offs((size_t)n + 1, 0), tgts;
+        for (uint32_t u = 0; u < n; ++u) offs[u + 1] = offs[u] + (uint32_t)out[u].size();
+        tgts.reserve(offs[n]);
+        for (const auto& adj : out) tgts.insert(tgts.end(), adj.begin(), adj.end());
+        CsrGraph g;
+        g.offsets = std::move(offs);
+        g.targets = std::move(tgts);
+        return g;
+    }
+
+    void clear() { out.clear(); in.clear(); ord.clear(); at.clear(); mark.clear(); ordered = false; }
+
+private:
+    vector<uint32_t> ord, at;                       // vertex -> position, position -> vertex
+    vector<uint8_t> mark;                           // DFS marks, all zero between calls
+    vector<uint32_t> deltaF, deltaB, stack, slots;
+    bool ordered = false;
+
+    // Marks everything reachable from s (forward: dependents with ord <= bound; backward:
+    // prerequisites with ord >= bound) into `seen`. Returns false as soon as it meets `stop`.
+    bool collect(uint32_t s, uint32_t bound, bool forward, vector<uint32_t>& seen, uint32_t stop) {
+        stack.assign(1, s);
+        mark[s] = 1; seen.push_back(s);
+        while (!stack.empty()) {
+            uint32_t u = stack.back(); stack.pop_back();
+            for (uint32_t w : forward ? out[u] : in[u]) {
+                if (w == stop) return false;
+                if (mark[w] || (forward ? ord[w] > bound : ord[w] < bound)) continue;
+                mark[w] = 1; seen.push_back(w);
+                stack.push_back(w);
+            }
+        }
+        return true;
+    }
+
+    // unbounded DFS for the cyclic case
+    bool reaches(uint32_t s, uint32_t target) {
+        deltaF.clear();
+        bool found = !collect(s, UINT32_MAX, true, deltaF, target);
+        for (uint32_t v : deltaF) mark[v] = 0;
+        return found;
+    }
+
+    // everything that must precede p (deltaB) moves in front of everything that must
+    // follow c (deltaF), reusing the positions the two sets already held
+    void reorder() {
+        auto byOrd = [&](uint32_t a, uint32_t b) { return ord[a] < ord[b]; };
+        sort(deltaB.begin(), deltaB.end(), byOrd);
+        sort(deltaF.begin(), deltaF.end(), byOrd);
+        slots.clear();
+        for (uint32_t v : deltaB) slots.push_back(ord[v]);
+        for (uint32_t v : deltaF) slots.push_back(ord[v]);
+        sort(slots.begin(), slots.end());
+        size_t i = 0;
+        for (uint32_t v : deltaB) { ord[v] = slots[i]; at[slots[i++]] = v; }
+        for (uint32_t v : deltaF) { ord[v] = slots[i]; at[slots[i++]] = v; }
+    }
+};
+
+// semester planning
+
+// how many slices forSlices() cuts `count` items into (1: run inline)
+static size_t sliceCount(ThreadPool* pool, size_t count) {
+    if (!pool || pool->size() < 2 || count < 16384) return 1;
+    return min(count / 4096, (size_t)pool->size() * 4);
+}
+
+// calls f(begin, end, slice) for `slices` contiguous pieces of [0, count) on the pool
+template <class F>
+static void forSlices(ThreadPool* pool, size_t count, size_t slices, F f) {
+    if (slices <= 1) { f((size_t)0, count, (size_t)0); return; }
+    vector<function<void()>> jobs;
+    for (size_t s = 0; s < slices; ++s)
+        jobs.push_back([&f, s, b = count * s / slices, e = count * (s + 1) / slices] { f(b, e, s); });
+    runAll(pool, std::move(jobs));
+}
+
+// Longest-chain structure of the prerequisite graph (prereq -> dependent). level[v] is the
+// number of courses in the longest prerequisite chain below v, i.e. the earliest term v
+// can be taken in (from 0); height[v] is the number of courses in the longest chain that
+// starts at v, v included. Courses on or behind a cycle are never released: NO_LEVEL and
+// height 0.
+struct CourseLevels {
+    static constexpr uint32_t NO_LEVEL = UINT32_MAX;
+    vector<uint32_t> level, height;
+    vector<uint32_t> byLevel;                       // released courses, level by level (level 0 by id)
+    vector<uint32_t> levelAt{ 0 };                  // level k is byLevel[levelAt[k] .. levelAt[k + 1])
+    size_t blocked = 0;                             // courses never released (cycles)
+
+    uint32_t levels() const { return (uint32_t)levelAt.size() - 1; }
+    IdRange atLevel(uint32_t k) const { return { byLevel.data() + levelAt[k], byLevel.data() + levelAt[k + 1] }; }
+
+    // one longest chain, first course first (ties go to the lowest id); empty when no
+    // course is released (an empty catalog, or every course on or behind a cycle)
+    vector<uint32_t> criticalPath(const CsrGraph& g) const {
+        vector<uint32_t> path;
+        if (levels() == 0) return path;
+        uint32_t v = NO_LEVEL;
+        for (uint32_t u : atLevel(0)) if (v == NO_LEVEL || height[u] > height[v]) v = u;
+        while (v != NO_LEVEL) {
+            path.push_back(v);
+            uint32_t next = NO_LEVEL;
+            for (uint32_t w : g.out(v))
+                if (height[w] && height[w] + 1 == height[v] && (next == NO_LEVEL || w < next)) next = w;
+            v = next;
+        }
+        return path;
+    }
+};
+
+// Level-synchronous Kahn over the vertices for which live(v) holds. Each frontier is split
+// across the pool: workers decrement in-degrees atomically and collect the vertices they
+// release into per-slice lists, which become the next frontier. Heights are then filled
+// in walking the levels backwards, one level at a time, with no atomics (every successor
+// of a level sits in a later one).
+template <class Live>
+static CourseLevels csrLevels(const CsrGraph& g, Live live, ThreadPool* pool) {
+    const uint32_t n = g.nodes();
+    CourseLevels lv;
+    lv.level.assign(n, CourseLevels::NO_LEVEL);
+    lv.height.assign(n, 0);
+    lv.byLevel.reserve(n);
+
+    unique_ptr<atomic<uint32_t>[]> indeg(new atomic<uint32_t>[n]);
+    forSlices(pool, n, sliceCount(pool, n), [&](size_t b, size_t e, size_t) {
+        for (size_t v = b; v < e; ++v) indeg[v].store(0, memory_order_relaxed);
+        });
+    forSlices(pool, n, sliceCount(pool, n), [&](size_t b, size_t e, size_t) {
+        for (size_t u = b; u < e; ++u)
+            if (live((uint32_t)u)) for (uint32_t v : g.out((uint32_t)u)) indeg[v].fetch_add(1, memory_order_relaxed);
+        });
+
+    // runs visit(i, out) for i in [0, count) and appends everything collected as the next level
+    vector<vector<uint32_t>> found;
+    auto nextLevel = [&](size_t count, auto visit) {
+        const size_t slices = sliceCount(pool, count);
+        found.resize(slices);
+        forSlices(pool, count, slices, [&](size_t b, size_t e, size_t s) {
+            found[s].clear();
+            for (size_t i = b; i < e; ++i) visit(i, found[s]);
+            });
+        for (size_t s = 0; s < slices; ++s) lv.byLevel.insert(lv.byLevel.end(), found[s].begin(), found[s].end());
+        lv.levelAt.push_back((uint32_t)lv.byLevel.size());
+        };
+
+    nextLevel(n, [&](size_t v, vector<uint32_t>& out) {
+        if (live((uint32_t)v) && indeg[v].load(memory_order_relaxed) == 0) out.push_back((uint32_t)v);
+        });
+    for (uint32_t k = 0; lv.levelAt[k + 1] > lv.levelAt[k]; ++k) {
+        const uint32_t first = lv.levelAt[k];
+        nextLevel(lv.levelAt[k + 1] - first, [&](size_t i, vector<uint32_t>& out) {
+            uint32_t u = lv.byLevel[first + i];
+            lv.level[u] = k;
+            for (uint32_t v : g.out(u)) if (indeg[v].fetch_sub(1, memory_order_relaxed) == 1) out.push_back(v);
+            });
+    }
+    lv.levelAt.pop_back();                          // the empty level that ended the loop
+
+    for (uint32_t k = lv.levels(); k-- > 0;) {
+        const uint32_t first = lv.levelAt[k];
+        const size_t count = lv.levelAt[k + 1] - first;
+        forSlices(pool, count, sliceCount(pool, count), [&](size_t b, size_t e, size_t) {
+            for (size_t i = b; i < e; ++i) {
+                uint32_t u = lv.byLevel[first + i], h = 0;
+                for (uint32_t w : g.out(u)) h = max(h, lv.height[w]);
+                lv.height[u] = h + 1;
+            }
+            });
     }
+    for (uint32_t v = 0; v < n; ++v) if (live(v) && lv.level[v] == CourseLevels::NO_LEVEL) lv.blocked++;
+    return lv;
+}
+
+struct SemesterPlan {
+    vector<vector<uint32_t>> terms;                 // course ids per term, ascending
+    vector<uint32_t> blocked;                       // wanted, but on or behind a cycle
+    uint32_t criticalLength = 0;                    // terms the plan would take with no cap
 };
 
-// avl tree
+// Assigns `wanted` (course ids still to take, closed under prerequisites) to terms of at
+// most maxPerTerm courses (0: no cap), each course after all of its prerequisites. Among
+// the courses that are ready, the ones heading the longest remaining chain go first
+// (Hu's list scheduling), so with no cap the plan is exactly criticalLength terms long.
+static SemesterPlan scheduleTerms(const CsrGraph& g, const CourseLevels& lv, vector<uint32_t> wanted, uint32_t maxPerTerm) {
+    SemesterPlan plan;
+    sort(wanted.begin(), wanted.end());
+    wanted.erase(unique(wanted.begin(), wanted.end()), wanted.end());
+    auto cut = stable_partition(wanted.begin(), wanted.end(), [&](uint32_t v) { return lv.level[v] != CourseLevels::NO_LEVEL; });
+    plan.blocked.assign(cut, wanted.end());
+    wanted.erase(cut, wanted.end());
+
+    const uint32_t m = (uint32_t)wanted.size();
+    const uint32_t NONE = UINT32_MAX;
+    vector<uint32_t> dense;                         // id -> position, for plans over much of the catalog
+    if ((size_t)m * 8 > g.nodes()) {
+        dense.assign(g.nodes(), NONE);
+        for (uint32_t i = 0; i < m; ++i) dense[wanted[i]] = i;
+    }
+    auto slot = [&](uint32_t v) {                   // position in wanted, NONE if not wanted
+        if (!dense.empty()) return dense[v];
+        auto it = lower_bound(wanted.begin(), wanted.end(), v);
+        return it != wanted.end() && *it == v ? (uint32_t)(it - wanted.begin()) : NONE;
+        };
+    // successors inside the set as flat lists, in wanted order
+    vector<uint32_t> succAt(m + 1, 0), succ, pending(m, 0), height(m, 0);
+    for (uint32_t i = 0; i < m; ++i) {
+        for (uint32_t w : g.out(wanted[i])) {
+            uint32_t j = slot(w);
+            if (j != NONE) { succ.push_back(j); pending[j]++; }
+        }
+        succAt[i + 1] = (uint32_t)succ.size();
+    }
+    // heights within the set, deepest level first (counting sort by level)
+    const uint32_t top = lv.levels();
+    vector<uint32_t> depthAt(top + 1, 0), byDepth(m);
+    for (uint32_t v : wanted) depthAt[top - lv.level[v]]++;
+    for (uint32_t k = 1; k <= top; ++k) depthAt[k] += depthAt[k - 1];
+    for (uint32_t i = 0; i < m; ++i) byDepth[depthAt[top - 1 - lv.level[wanted[i]]]++] = i;
+    for (uint32_t i : byDepth) {
+        uint32_t h = 0;
+        for (uint32_t k = succAt[i]; k < succAt[i + 1]; ++k) h = max(h, height[succ[k]]);
+        height[i] = h + 1;
+        plan.criticalLength = max(plan.criticalLength, h + 1);
+    }
+
+    auto later = [&](uint32_t a, uint32_t b) {      // heap order: tallest first, then lowest id
+        return height[a] != height[b] ? height[a] < height[b] : a > b;
+        };
+    vector<uint32_t> ready, released;
+    for (uint32_t i = 0; i < m; ++i) if (!pending[i]) ready.push_back(i);
+    make_heap(ready.begin(), ready.end(), later);
+    for (uint32_t placed = 0; placed < m;) {
+        if (ready.empty()) break;                   // only if `wanted` was not closed under prerequisites
+        vector<uint32_t> term;
+        while (!ready.empty() && (!maxPerTerm || term.size() < maxPerTerm)) {
+            pop_heap(ready.begin(), ready.end(), later);
+            term.push_back(ready.back());
+            ready.pop_back();
+        }
+        released.clear();
+        for (uint32_t i : term)
+            for (uint32_t k = succAt[i]; k < succAt[i + 1]; ++k) if (--pending[succ[k]] == 0) released.push_back(succ[k]);
+        for (uint32_t j : released) { ready.push_back(j); push_heap(ready.begin(), ready.end(), later); }
+        placed += (uint32_t)term.size();
+        for (uint32_t& i : term) i = wanted[i];
+        sort(term.begin(), term.end());
+        plan.terms.push_back(std::move(term));
+    }
+    return plan;
+}
+
+// downstream impact
+
+// Which courses need one of a set of source courses, directly or not: everything the
+// sources reach along prerequisite -> dependent edges (the sources themselves are not
+// listed). Up to LANES queries run together, one bit each in per-course words, so a
+// batch shares every pass over the graph. Each BFS level is expanded top-down (the
+// frontier pushes to its dependents) or bottom-up (every unfinished course pulls from
+// its prerequisites, stopping at the first hit): bottom-up once the frontier's edges
+// outweigh the in-edges a bottom-up level would check (first guess 1/ALPHA of those of
+// unreached courses, then the share the last bottom-up level really checked, which is
+// most of them in a layered catalog), top-down again once that stops holding or the
+// frontier is under 1/BETA of the courses. Not thread-safe: runs share the scratch arrays.
+enum class BfsMode { Auto, TopDown, BottomUp };
+
+class ImpactSearch {
+public:
+    static constexpr size_t LANES = 64;
+    static constexpr size_t ALPHA = 14, BETA = 24;     // the usual direction-optimizing thresholds
+
+    size_t levels = 0, bottomUpLevels = 0;              // of the last pass, for benchmarks
+
+    // Calls f(i, ids) for every query i (source course ids), in order. ids are in id
+    // order and valid only during the call.
+    template <class F>
+    void run(const CsrGraph& g, const CsrGraph& rg, const vector<vector<uint32_t>>& queries, F f, BfsMode mode = BfsMode::Auto) {
+        const uint32_t n = g.nodes();
+        if (seen.size() != n) {
+            seen.assign(n, 0);
+            cur.assign(n, 0);
+            nxt.assign(n, 0);
+        }
+        for (size_t first = 0; first < queries.size(); first += LANES) {
+            size_t count = min(LANES, queries.size() - first);
+            search(g, rg, queries, first, count, mode);
+            for (size_t q = 0; q < count; ++q) f(first + q, IdRange{ found[q].data(), found[q].data() + found[q].size() });
+        }
+    }
+
+    size_t memoryBytes() const {
+        size_t bytes = (seen.capacity() + cur.capacity() + nxt.capacity()) * sizeof(uint64_t)
+            + (curList.capacity() + nxtList.capacity() + touched.capacity()) * sizeof(uint32_t);
+        for (const auto& f : found) bytes += f.capacity() * sizeof(uint32_t);
+        return bytes;
+    }
+
+private:
+    vector<uint64_t> seen, cur, nxt;                    // lanes that reached / are expanding / will expand v
+    vector<uint32_t> curList, nxtList;                  // courses with a non-zero cur / nxt word
+    vector<uint32_t> touched;                           // courses with a non-zero seen word
+    vector<vector<uint32_t>> found;                     // per lane, reused across passes
+
+    void search(const CsrGraph& g, const CsrGraph& rg, const vector<vector<uint32_t>>& queries, size_t first, size_t count, BfsMode mode) {
+        const uint32_t n = g.nodes();
+        const uint64_t all = count == LANES ? ~0ull : (1ull << count) - 1;
+        size_t unexplored = rg.edges();                 // in-edges of courses no lane has reached
+        auto reach = [&](uint32_t v, uint64_t lanes) {
+            if (!seen[v]) { touched.push_back(v); unexplored -= rg.degree(v); }
+            seen[v] |= lanes;
+            if (!nxt[v]) nxtList.push_back(v);
+            nxt[v] |= lanes;
+            };
+        for (size_t q = 0; q < count; ++q)
+            for (uint32_t s : queries[first + q]) if (s < n) reach(s, 1ull << q);
+
+        bool bottomUp = false;
+        double checkRate = 1.0 / ALPHA;                 // share of those in-edges a bottom-up level checks
+        levels = bottomUpLevels = 0;
+        while (!nxtList.empty()) {
+            for (uint32_t v : curList) cur[v] = 0;      // cur all zero, then it takes nxt's words
+            swap(cur, nxt);
+            swap(curList, nxtList);
+            nxtList.clear();
+            if (mode == BfsMode::Auto) {
+                size_t frontierEdges = 0;
+                for (uint32_t v : curList) frontierEdges += g.degree(v);
+                bool cheaper = frontierEdges > unexplored * checkRate;
+                bottomUp = bottomUp ? cheaper && curList.size() >= n / BETA : cheaper;
+            }
+            else bottomUp = mode == BfsMode::BottomUp;
+            ++levels;
+            bottomUpLevels += bottomUp;
+
+            if (bottomUp) {
+                size_t before = unexplored, checked = 0;
+                for (uint32_t v = 0; v < n; ++v) {
+                    uint64_t missing = all & ~seen[v];
+                    if (!missing) continue;
+                    uint64_t got = 0;
+                    for (uint32_t u : rg.out(v)) {
+                        ++checked;
+                        got |= cur[u] & missing;
+                        if (got == missing) break;
+                    }
+                    if (got) reach(v, got);
+                }
+                if (before) checkRate = (double)checked / (double)before;
+            }
+            else {
+                for (uint32_t v : curList) {
+                    uint64_t lanes = cur[v];
+                    for (uint32_t w : g.out(v)) {
+                        uint64_t fresh = lanes & ~seen[w];
+                        if (fresh) reach(w, fresh);
+                    }
+                }
+            }
+        }
+        for (uint32_t v : curList) cur[v] = 0;
+        curList.clear();
+
+        // sources are not their own impact; then gather in id order and leave seen all zero
+        for (size_t q = 0; q < count; ++q)
+            for (uint32_t s : queries[first + q]) if (s < n) seen[s] &= ~(1ull << q);
+        if (found.size() < count) found.resize(count);
+        for (size_t q = 0; q < count; ++q) found[q].clear();
+        auto gather = [&](uint32_t v) { for (uint64_t m = seen[v]; m; m &= m - 1) found[lowestBit(m)].push_back(v); };
+        if (touched.size() * 16 > n) for (uint32_t v = 0; v < n; ++v) gather(v);
+        else {
+            sort(touched.begin(), touched.end());
+            for (uint32_t v : touched) gather(v);
+        }
+        for (uint32_t v : touched) seen[v] = 0;
+        touched.clear();
+    }
+};
+
+//model
+
+// A Course is a 40-byte record. A code of up to CODE_INLINE characters and a list of up
+// to PREREQ_INLINE prerequisite ids are copied into the record itself, which covers
+// nearly every course; the title, and longer codes and lists, are views into the
+// catalog's pools (CSV load), a mapped snapshot, or text kept by edits. Views returned
+// by the accessors may point into the record, so they last only as long as it stays put.
+class Course {
+public:
+    static constexpr size_t CODE_INLINE = 11;
+    static constexpr uint32_t PREREQ_INLINE = 2;
+
+    uint32_t id = 0;                   // dense id (also the index into CourseCatalog::courses)
+    uint32_t removed : 1;              // no course row: deleted, or a code only ever used as a prereq
+
+    Course() : removed(0), prereqCount(0) {}
+
+    string_view courseNumber() const {  // ex "CSCI300"
+        if (codeLen != LONG_CODE) return { code, codeLen };
+        const char* p;
+        uint32_t len = 0;
+        memcpy(&p, code, sizeof p);
+        memcpy(&len, code + sizeof p, 3);
+        return { p, len };
+    }
+    string_view courseTitle() const { return { title, titleLen }; }   // ex "Data Structures"
+    IdRange prerequisites() const {     // interned ids of the prerequisite codes
+        const uint32_t* p = prereqCount <= PREREQ_INLINE ? prereqs.inl : prereqs.spill;
+        return { p, p + prereqCount };
+    }
+
+    // Long codes and lists are not copied: they must outlive the record.
+    void setCourseNumber(string_view s) {
+        if (s.size() <= CODE_INLINE) {
+            memcpy(code, s.data(), s.size());
+            codeLen = (uint8_t)s.size();
+            return;
+        }
+        const char* p = s.data();
+        uint32_t len = (uint32_t)min<size_t>(s.size(), 0xFFFFFF);
+        memcpy(code, &p, sizeof p);
+        memcpy(code + sizeof p, &len, 3);
+        codeLen = LONG_CODE;
+    }
+    void setCourseTitle(string_view s) { title = s.data(); titleLen = (uint32_t)s.size(); }
+    void setPrerequisites(IdRange r) {
+        prereqCount = (uint32_t)r.size();
+        if (r.size() <= PREREQ_INLINE) copy(r.begin(), r.end(), prereqs.inl);
+        else prereqs.spill = r.begin();
+    }
+
+private:
+    static constexpr uint8_t LONG_CODE = 0xFF;
+    static_assert(CODE_INLINE >= sizeof(const char*) + 3, "long codes are stored as pointer + 24-bit length");
+
+    uint32_t prereqCount : 31;         // shares a word with removed
+    const char* title = nullptr;
+    union { uint32_t inl[PREREQ_INLINE]; const uint32_t* spill; } prereqs{};
+    uint32_t titleLen = 0;
+    char code[CODE_INLINE] = {};
+    uint8_t codeLen = 0;
+};
+static_assert(sizeof(void*) != 8 || sizeof(Course) == 40, "Course layout changed; update the comment above");
+
+// eligibility
+
+// 64x64 bit matrix transpose in place: bit c of a[r] swaps with bit r of a[c]
+static void transposeBits(uint64_t a[64]) {
+    uint64_t m = 0x00000000FFFFFFFFull;
+    for (unsigned j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (unsigned k = 0; k < 64; k = (k + j + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k + j]) & m;
+            a[k] ^= t << j;
+            a[k + j] ^= t;
+        }
+    }
+}
+
+// Which courses each of a batch of students can take next: every course a student has
+// not completed whose prerequisites (codes with no course row included) are all in the
+// transcript. Transcripts are taken as given; unlike planSemesters, nothing below a
+// completed course is assumed passed.
+// Students are bit-sliced. A pass sets bit s of done[id] when student s has completed
+// id, then ANDs those words along each course's prerequisite list, so one walk over the
+// lists answers up to LANES students with fixed-width word operations the compiler can
+// vectorize. Answers stay bits: every 64 courses the per-course words are transposed
+// into per-student words, so a student's answer is a bitset over the live courses.
+// Not thread-safe: passes share their scratch arrays (done is left all zero).
+class EligibilityEngine {
+public:
+    static constexpr size_t WIDE = 4;                   // words per id in a full pass
+    static constexpr size_t LANES = 64 * WIDE;          // students per full pass
+
+    // one student's answer: a bit per live course, in id order
+    class Courses {
+    public:
+        size_t size() const {
+            size_t n = 0;
+            for (size_t w = 0; w < words; ++w) n += bitCount(bits[w]);
+            return n;
+        }
+        template <class F>
+        void forEach(F f) const {
+            for (size_t w = 0; w < words; ++w)
+                for (uint64_t m = bits[w]; m; m &= m - 1) f(live[64 * w + lowestBit(m)]);
+        }
+
+    private:
+        friend class EligibilityEngine;
+        const uint64_t* bits;
+        size_t words;
+        const uint32_t* live;
+    };
+
+    // `codes` bounds every id a prerequisite list or transcript can hold
+    void build(const vector<Course>& courses, size_t codes) {
+        live.clear();
+        offsets.assign(1, 0);
+        prereqs.clear();
+        for (const Course& c : courses) {
+            if (c.removed) continue;
+            live.push_back(c.id);
+            IdRange r = c.prerequisites();
+            prereqs.insert(prereqs.end(), r.begin(), r.end());
+            offsets.push_back((uint32_t)prereqs.size());
+        }
+        universe = max(codes, courses.size());
+        vector<uint64_t>().swap(done);                  // sized by the first run
+    }
+
+    // Calls f(i, courses) for every transcript i (course ids in any order), in order.
+    // `courses` is valid only during the call.
+    template <class F>
+    void run(const vector<vector<uint32_t>>& transcripts, F f) {
+        if (done.size() < universe * WIDE) done.assign(universe * WIDE, 0);
+        const size_t words = (live.size() + 63) / 64;
+        for (size_t first = 0; first < transcripts.size(); first += LANES) {
+            size_t count = min(LANES, transcripts.size() - first);
+            if (found.size() < count * words) found.resize(count * words);
+            if (count <= 64) pass<1>(transcripts, first, count);     // a narrow pass for small batches
+            else pass<WIDE>(transcripts, first, count);
+            Courses answer;
+            answer.words = words;
+            answer.live = live.data();
+            for (size_t s = 0; s < count; ++s) {
+                answer.bits = found.data() + s * words;
+                f(first + s, answer);
+            }
+        }
+    }
+
+    vector<uint32_t> eligible(const vector<uint32_t>& completed) {
+        vector<uint32_t> ids;
+        run({ completed }, [&](size_t, const Courses& c) { c.forEach([&](uint32_t id) { ids.push_back(id); }); });
+        return ids;
+    }
+
+    size_t memoryBytes() const {
+        return (live.capacity() + offsets.capacity() + prereqs.capacity()) * sizeof(uint32_t)
+            + (done.capacity() + found.capacity()) * sizeof(uint64_t);
+    }
+
+private:
+    vector<uint32_t> live;                              // live course ids
+    vector<uint32_t> offsets{ 0 };                      // prerequisites of live[i]: prereqs[offsets[i] .. offsets[i + 1])
+    vector<uint32_t> prereqs;
+    size_t universe = 0;
+    vector<uint64_t> done;                              // W words per id during a pass of width W
+    vector<uint64_t> found;                             // per student, a bit per live course
+
+    template <size_t W>
+    void pass(const vector<vector<uint32_t>>& transcripts, size_t first, size_t count) {
+        uint64_t* bits = done.data();
+        auto mark = [&](bool set) {                     // clearing drops whole words: only this pass set them
+            for (size_t s = 0; s < count; ++s) {
+                for (uint32_t id : transcripts[first + s]) {
+                    if (id >= universe) continue;
+                    uint64_t& w = bits[(size_t)id * W + s / 64];
+                    w = set ? w | (1ull << (s % 64)) : 0;
+                }
+            }
+            };
+        mark(true);
+        uint64_t lanes[W];                              // students present in this pass
+        for (size_t k = 0; k < W; ++k)
+            lanes[k] = count >= 64 * (k + 1) ? ~0ull : count > 64 * k ? (1ull << (count - 64 * k)) - 1 : 0;
+
+        const size_t words = (live.size() + 63) / 64;
+        uint64_t block[W][64];                          // [lane word][course in block]
+        for (size_t base = 0; base < live.size(); base += 64) {
+            size_t rows = min<size_t>(64, live.size() - base);
+            for (size_t r = 0; r < rows; ++r) {
+                size_t i = base + r;
+                uint64_t acc[W];
+                const uint64_t* own = bits + (size_t)live[i] * W;
+                for (size_t k = 0; k < W; ++k) acc[k] = lanes[k] & ~own[k];
+                for (uint32_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+                    const uint64_t* req = bits + (size_t)prereqs[j] * W;
+                    for (size_t k = 0; k < W; ++k) acc[k] &= req[k];
+                }
+                for (size_t k = 0; k < W; ++k) block[k][r] = acc[k];
+            }
+            for (size_t k = 0; k < W && 64 * k < count; ++k) {
+                fill(block[k] + rows, block[k] + 64, 0);
+                transposeBits(block[k]);                // now [student in lane word][course bit]
+                for (size_t s = 0; s < 64 && 64 * k + s < count; ++s) found[(64 * k + s) * words + base / 64] = block[k][s];
+            }
+        }
+        mark(false);
+    }
+};
+
+// csv parsing
+
+// one CSV row before interning; views point into the source buffer
+struct CsvRow {
+    size_t line;
+    string_view number;
+    string_view title;
+    string_view prereqs;               // rest of the row, still comma separated
+};
+
+// calls f(trimmed field) for every non-empty field of a comma separated list
+template <class F>
+static void forEachField(string_view list, F f) {
+    while (!list.empty()) {
+        size_t c = list.find(',');
+        string_view p = trimView(list.substr(0, c));
+        if (!p.empty()) f(p);
+        if (c == string_view::npos) break;
+        list.remove_prefix(c + 1);
+    }
+}
+
+// calls f(line) for every non-empty '\n' terminated line
+template <class F>
+static void forEachLine(string_view text, F f) {
+    while (!text.empty()) {
+        size_t nl = text.find('\n');
+        if (nl != 0) f(text.substr(0, nl));
+        if (nl == string_view::npos) break;
+        text.remove_prefix(nl + 1);
+    }
+}
+
+// row shape produced by the original stream parser
+struct StreamRow {
+    string courseNumber;
+    string courseTitle;
+    vector<string> prerequisites;
+};
+
+// Original getline/stringstream path. Kept as the reference for benchmarkLoad.
+static void parseCatalogStream(istream& in, vector<StreamRow>& out, vector<string>& malformed) {
+    string line;
+    size_t lineNo = 0;
+    while (getline(in, line)) {
+        ++lineNo;
+        if (trim(line).empty()) continue;
+        stringstream ss(line);
+        string num, title, prereq;
+        vector<string> prereqs;
+
+        if (!getline(ss, num, ',')) { malformed.push_back("Line " + to_string(lineNo) + ": missing course number"); continue; }
+        if (!getline(ss, title, ',')) { malformed.push_back("Line " + to_string(lineNo) + ": missing course title"); continue; }
+
+        num = toUpper(trim(num));
+        title = trim(title);
+        if (num.empty() || title.empty()) {
+            malformed.push_back("Line " + to_string(lineNo) + ": empty course number/title");
+            continue;
+        }
+
+        while (getline(ss, prereq, ',')) {
+            prereq = toUpper(trim(prereq));
+            if (!prereq.empty()) prereqs.push_back(prereq);
+        }
+        out.push_back({ num, title, prereqs });
+    }
+}
+
+// Tokenizes a mapped buffer in place. Fields are string_views into `text`, so nothing is
+// allocated per row. Same rules and diagnostics as parseCatalogStream (a row needs at
+// least "number," followed by something).
+static void parseCatalogText(string_view text, size_t firstLine, vector<CsvRow>& out, vector<string>& malformed) {
+    size_t lineNo = firstLine - 1;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == string_view::npos) eol = text.size();
+        string_view line = text.substr(pos, eol - pos);
+        pos = eol + 1;
+        ++lineNo;
+        if (trimView(line).empty()) continue;
+
+        size_t c1 = line.find(',');
+        if (c1 == string_view::npos || c1 + 1 == line.size()) {
+            malformed.push_back("Line " + to_string(lineNo) + ": missing course title");
+            continue;
+        }
+        size_t c2 = line.find(',', c1 + 1);
+        string_view num = trimView(line.substr(0, c1));
+        string_view title = trimView(line.substr(c1 + 1, c2 == string_view::npos ? string_view::npos : c2 - c1 - 1));
+        if (num.empty() || title.empty()) {
+            malformed.push_back("Line " + to_string(lineNo) + ": empty course number/title");
+            continue;
+        }
+
+        string_view prereqs = (c2 == string_view::npos) ? string_view() : line.substr(c2 + 1);
+        out.push_back({ lineNo, num, title, prereqs });
+    }
+}
+
+// Splits the buffer into chunks that end on '\n', counts lines per chunk so every chunk
+// knows its first source line, then tokenizes the chunks concurrently into per-chunk
+// staging vectors and concatenates them in file order. Diagnostics keep file line numbers.
+static void parseCatalogParallel(string_view text, ThreadPool& pool, vector<CsvRow>& out, vector<string>& malformed,
+    size_t minChunkBytes = 1 << 20) {
+    size_t want = (size_t)pool.size() * 4; // oversplit a little for load balance
+    size_t chunks = max<size_t>(1, min(want, text.size() / max<size_t>(1, minChunkBytes)));
+    if (chunks == 1) { parseCatalogText(text, 1, out, malformed); return; }
+
+    vector<string_view> parts;
+    size_t begin = 0;
+    for (size_t i = 1; i <= chunks && begin < text.size(); ++i) {
+        size_t end = (i == chunks) ? text.size() : max(begin, text.size() * i / chunks);
+        if (end < text.size()) {
+            size_t nl = text.find('\n', end);
+            end = (nl == string_view::npos) ? text.size() : nl + 1;
+        }
+        if (end > begin) parts.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    vector<size_t> firstLine(parts.size() + 1, 1);
+    vector<vector<CsvRow>> stagedParts(parts.size());
+    vector<vector<string>> badParts(parts.size());
+    vector<function<void()>> jobs;
+
+    for (size_t i = 0; i < parts.size(); ++i)
+        jobs.push_back([&, i] { firstLine[i + 1] = (size_t)count(parts[i].begin(), parts[i].end(), '\n'); });
+    runAll(&pool, std::move(jobs));
+    for (size_t i = 1; i <= parts.size(); ++i) firstLine[i] += firstLine[i - 1];
+
+    jobs.clear();
+    for (size_t i = 0; i < parts.size(); ++i)
+        jobs.push_back([&, i] { parseCatalogText(parts[i], firstLine[i], stagedParts[i], badParts[i]); });
+    runAll(&pool, std::move(jobs));
+
+    size_t total = out.size();
+    for (auto& sp : stagedParts) total += sp.size();
+    out.reserve(total);
+    for (size_t i = 0; i < parts.size(); ++i) {
+        move(stagedParts[i].begin(), stagedParts[i].end(), back_inserter(out));
+        move(badParts[i].begin(), badParts[i].end(), back_inserter(malformed));
+    }
+}
+
+// node pool
+
+// Bump allocator for tree nodes: nodes are carved out of fixed-size blocks and never
+// returned to the heap one at a time (recycle() only queues a node for the next make()).
+// reset() rewinds to the first block (the blocks are kept for the next load), so emptying
+// a tree is O(1) instead of a recursive delete walk.
+template <class Node, size_t BlockNodes = 4096>
+class NodePool {
+    static_assert(is_trivially_destructible<Node>::value, "pool never runs node destructors");
+    vector<void*> blocks;
+    vector<Node*> spare;                              // recycled nodes, reused before fresh ones
+    size_t next = 0;                                  // nodes handed out since the last reset
+
+    void release() {
+        for (void* b : blocks) ::operator delete(b);
+        blocks.clear();
+        spare.clear();
+        next = 0;
+    }
+
+public:
+    NodePool() = default;
+    ~NodePool() { release(); }
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    NodePool(NodePool&& o) noexcept : blocks(std::move(o.blocks)), spare(std::move(o.spare)), next(o.next) {
+        o.blocks.clear(); o.spare.clear(); o.next = 0;
+    }
+    NodePool& operator=(NodePool&& o) noexcept {
+        if (this != &o) {
+            release();
+            blocks = std::move(o.blocks); spare = std::move(o.spare); next = o.next;
+            o.blocks.clear(); o.spare.clear(); o.next = 0;
+        }
+        return *this;
+    }
+
+    template <class... Args>
+    Node* make(Args&&... args) {
+        if (!spare.empty()) {
+            Node* n = spare.back();
+            spare.pop_back();
+            return new (n) Node(std::forward<Args>(args)...);
+        }
+        size_t b = next / BlockNodes;
+        if (b == blocks.size()) blocks.push_back(::operator new(sizeof(Node) * BlockNodes));
+        void* slot = static_cast<char*>(blocks[b]) + sizeof(Node) * (next % BlockNodes);
+        ++next;
+        return new (slot) Node(std::forward<Args>(args)...);
+    }
+
+    void recycle(Node* n) { spare.push_back(n); }
+    void reset() { next = 0; spare.clear(); }
+    size_t size() const { return next - spare.size(); }
+    size_t bytesReserved() const { return blocks.size() * BlockNodes * sizeof(Node); }
+};
+
+// rewrites every node's course pointer from one store base to another (explicit stack)
+template <class Node>
+static void rebaseTree(Node* root, const Course* from, const Course* to) {
+    vector<Node*> stack;
+    if (root) stack.push_back(root);
+    while (!stack.empty()) {
+        Node* n = stack.back(); stack.pop_back();
+        n->course = to + (n->course - from);
+        if (n->left) stack.push_back(n->left);
+        if (n->right) stack.push_back(n->right);
+    }
+}
+
+// levels on the longest root-to-leaf path (explicit stack; an unbalanced tree can be deep)
+template <class Node>
+static int treeHeight(const Node* root) {
+    int best = 0;
+    vector<pair<const Node*, int>> stack;
+    if (root) stack.emplace_back(root, 1);
+    while (!stack.empty()) {
+        auto [n, d] = stack.back(); stack.pop_back();
+        best = max(best, d);
+        if (n->left) stack.emplace_back(n->left, d + 1);
+        if (n->right) stack.emplace_back(n->right, d + 1);
+    }
+    return best;
+}
+
+// unbalanced binary search tree
+
+// tree nodes point into the catalog's course store; they never own a Course
+
+struct TreeNode {
+    const Course* course;
+    TreeNode* left;
+    TreeNode* right;
+    explicit TreeNode(const Course* c) : course(c), left(nullptr), right(nullptr) {}
+};
+
+class BinarySearchTree {
+    NodePool<TreeNode> pool;
+    TreeNode* root = nullptr;
+
+    TreeNode* insertRec(TreeNode* node, const Course* c) {
+        if (!node) return pool.make(c);
+        if (compareCode(c->courseNumber(), node->course->courseNumber()) < 0) node->left = insertRec(node->left, c);
+        else node->right = insertRec(node->right, c);
+        return node;
+    }
+
+    // perfectly balanced subtree from order[lo, hi), which must already be sorted by code
+    TreeNode* buildRec(const vector<Course>& store, const FlatArray<uint32_t>& order, size_t lo, size_t hi) {
+        if (lo >= hi) return nullptr;
+        size_t mid = lo + (hi - lo) / 2;
+        TreeNode* node = pool.make(&store[order[mid]]);
+        node->left = buildRec(store, order, lo, mid);
+        node->right = buildRec(store, order, mid + 1, hi);
+        return node;
+    }
+
+    static TreeNode* searchRec(TreeNode* node, string_view key) {
+        if (!node) return node;
+        int cmp = compareCode(key, node->course->courseNumber());
+        if (cmp == 0) return node;
+        return cmp < 0
+            ? searchRec(node->left, key)
+            : searchRec(node->right, key);
+    }
+
+    template <class F>
+    static void inOrderRec(TreeNode* node, F& f) {
+        if (!node) return;
+        inOrderRec(node->left, f);
+        f(*node->course);
+        inOrderRec(node->right, f);
+    }
+
+    TreeNode* removeRec(TreeNode* node, string_view key, bool& removed) {
+        if (!node) return nullptr;
+        int cmp = compareCode(key, node->course->courseNumber());
+        if (cmp < 0) node->left = removeRec(node->left, key, removed);
+        else if (cmp > 0) node->right = removeRec(node->right, key, removed);
+        else {
+            removed = true;
+            if (node->left && node->right) {        // take over the in-order successor
+                TreeNode* s = node->right;
+                while (s->left) s = s->left;
+                node->course = s->course;
+                bool dummy = false;
+                node->right = removeRec(node->right, s->course->courseNumber(), dummy);
+                return node;
+            }
+            TreeNode* child = node->left ? node->left : node->right;
+            pool.recycle(node);
+            return child;
+        }
+        return node;
+    }
+
+public:
+    BinarySearchTree() = default;
+    BinarySearchTree(const BinarySearchTree&) = delete;
+    BinarySearchTree& operator=(const BinarySearchTree&) = delete;
+    BinarySearchTree(BinarySearchTree&& o) noexcept : pool(std::move(o.pool)), root(o.root) { o.root = nullptr; }
+    BinarySearchTree& operator=(BinarySearchTree&& o) noexcept {
+        if (this != &o) { pool = std::move(o.pool); root = o.root; o.root = nullptr; }
+        return *this;
+    }
+
+    void clear() { pool.reset(); root = nullptr; }
+    void insert(const Course& c) { root = insertRec(root, &c); }  // incremental additions
+    bool remove(string_view key) { bool removed = false; root = removeRec(root, key, removed); return removed; }  // any case
+    // bulk load in O(n): replaces the tree with a balanced one over ids sorted by code
+    void build(const vector<Course>& store, const FlatArray<uint32_t>& sortedIds) {
+        clear();
+        root = buildRec(store, sortedIds, 0, sortedIds.size());
+    }
+    // the course store moved (it grew); point every node at the same slot in the new one
+    void rebase(const Course* from, const Course* to) { rebaseTree(root, from, to); }
+    const Course* search(string_view key) const {       // any case
+        TreeNode* n = searchRec(root, key);
+        return n ? n->course : nullptr;
+    }
+    template <class F>
+    void forEachInOrder(F f) const { inOrderRec(root, f); }
+    int height() const { return treeHeight(root); }
+    size_t nodeCount() const { return pool.size(); }
+    size_t memoryBytes() const { return pool.bytesReserved(); }
+    // one buffered write instead of a stream insertion per field
+    void printInOrder() const {
+        string out = "Here is a sample schedule:\n\n";
+        forEachInOrder([&](const Course& c) {
+            out += c.courseNumber(); out += ", "; out += c.courseTitle(); out += '\n';
+            });
+        cout.write(out.data(), (streamsize)out.size());
+    }
+};
+
+// avl tree
+
+struct AVLNode {
+    const Course* course;
+    AVLNode* left;
+    AVLNode* right;
+    int height;
+    explicit AVLNode(const Course* c) : course(c), left(nullptr), right(nullptr), height(1) {}
+};
+
+class AVLTree {
+    NodePool<AVLNode> pool;
+    AVLNode* root = nullptr;
+
+    static int h(AVLNode* n) { return n ? n->height : 0; }
+    static int bf(AVLNode* n) { return n ? h(n->left) - h(n->right) : 0; }
+
+    static void update(AVLNode* n) {
+        if (n) n->height = 1 + max(h(n->left), h(n->right));
+    }
+
+    static AVLNode* rotateRight(AVLNode* y) {
+        AVLNode* x = y->left;
+        AVLNode* T2 = x->right;
+        x->right = y; y->left = T2;
+        update(y); update(x);
+        return x;
+    }
+
+    static AVLNode* rotateLeft(AVLNode* x) {
+        AVLNode* y = x->right;
+        AVLNode* T2 = y->left;
+        y->left = x; x->right = T2;
+        update(x); update(y);
+        return y;
+    }
+
+    static AVLNode* balance(AVLNode* node) {
+        update(node);
+        int b = bf(node);
+        if (b > 1) {
+            if (bf(node->left) < 0) node->left = rotateLeft(node->left);
+            return rotateRight(node);
+        }
+        if (b < -1) {
+            if (bf(node->right) > 0) node->right = rotateRight(node->right);
+            return rotateLeft(node);
+        }
+        return node;
+    }
+
+    AVLNode* insertRec(AVLNode* node, const Course* c) {
+        if (!node) return pool.make(c);
+        if (compareCode(c->courseNumber(), node->course->courseNumber()) < 0) node->left = insertRec(node->left, c);
+        else node->right = insertRec(node->right, c);
+        return balance(node);
+    }
+
+    // balanced subtree from order[lo, hi) with heights filled in bottom-up; no rotations needed
+    AVLNode* buildRec(const vector<Course>& store, const FlatArray<uint32_t>& order, size_t lo, size_t hi) {
+        if (lo >= hi) return nullptr;
+        size_t mid = lo + (hi - lo) / 2;
+        AVLNode* node = pool.make(&store[order[mid]]);
+        node->left = buildRec(store, order, lo, mid);
+        node->right = buildRec(store, order, mid + 1, hi);
+        update(node);
+        return node;
+    }
+
+    static const Course* searchRec(AVLNode* node, string_view key) {
+        if (!node) return nullptr;
+        int cmp = compareCode(key, node->course->courseNumber());
+        if (cmp == 0) return node->course;
+        if (cmp < 0) return searchRec(node->left, key);
+        return searchRec(node->right, key);
+    }
+
+    AVLNode* removeRec(AVLNode* node, string_view key, bool& removed) {
+        if (!node) return nullptr;
+        int cmp = compareCode(key, node->course->courseNumber());
+        if (cmp < 0) node->left = removeRec(node->left, key, removed);
+        else if (cmp > 0) node->right = removeRec(node->right, key, removed);
+        else {
+            removed = true;
+            if (node->left && node->right) {        // take over the in-order successor
+                AVLNode* s = node->right;
+                while (s->left) s = s->left;
+                node->course = s->course;
+                bool dummy = false;
+                node->right = removeRec(node->right, s->course->courseNumber(), dummy);
+            }
+            else {
+                AVLNode* child = node->left ? node->left : node->right;
+                pool.recycle(node);
+                return child;
+            }
+        }
+        return balance(node);
+    }
+
+public:
+    AVLTree() = default;
+    AVLTree(const AVLTree&) = delete;
+    AVLTree& operator=(const AVLTree&) = delete;
+    AVLTree(AVLTree&& o) noexcept : pool(std::move(o.pool)), root(o.root) { o.root = nullptr; }
+    AVLTree& operator=(AVLTree&& o) noexcept {
+        if (this != &o) { pool = std::move(o.pool); root = o.root; o.root = nullptr; }
+        return *this;
+    }
+
+    void clear() { pool.reset(); root = nullptr; }
+    void insert(const Course& c) { root = insertRec(root, &c); }  // incremental additions
+    bool remove(string_view key) { bool removed = false; root = removeRec(root, key, removed); return removed; }  // any case
+    // bulk load in O(n): replaces the tree with a balanced one over ids sorted by code
+    void build(const vector<Course>& store, const FlatArray<uint32_t>& sortedIds) {
+        clear();
+        root = buildRec(store, sortedIds, 0, sortedIds.size());
+    }
+    // the course store moved (it grew); point every node at the same slot in the new one
+    void rebase(const Course* from, const Course* to) { rebaseTree(root, from, to); }
+    const Course* search(string_view key) const { return searchRec(root, key); } // any case
+    int height() const { return h(root); }
+    size_t nodeCount() const { return pool.size(); }
+    size_t memoryBytes() const { return pool.bytesReserved(); }
+};
+
+// static search index (Eytzinger layout, packed keys)
+
+// Packs the first 8 bytes of a code big-endian (letters folded to uppercase), so comparing
+// keys as integers orders them like the strings. Codes under 8 chars map to unique keys; a
+// code of 8 or more shares its key with every code that starts with the same 8 bytes, so
+// those are confirmed with a string compare.
+static inline uint64_t packCode(string_view s) {
+    uint64_t k = 0;
+    for (size_t i = 0; i < 8; ++i) k = (k << 8) | (i < s.size() ? foldCode((unsigned char)s[i]) : 0u);
+    return k;
+}
+
+// trailing one bits of k, plus one (how far to climb back up after a lower_bound descent)
+static inline unsigned climbBits(size_t k) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(~(unsigned long long)k) + 1;
+#else
+    unsigned n = 1;
+    while (k & 1) { k >>= 1; ++n; }
+    return n;
+#endif
+}
+
+// Read-only sorted index. Keys sit in BFS order of an implicit complete binary tree
+// (slot k has children 2k and 2k+1), so the top levels share a few cache lines and the
+// descent is a branch-free loop that prefetches its great-grandchildren.
+class EytzingerIndex {
+    FlatArray<uint64_t> keys;          // slot -> packed key; slot 0 unused
+    FlatArray<uint32_t> slotIds;       // slot -> course id
+    FlatArray<uint32_t> rank;          // slot -> position in sorted order
+    FlatArray<uint32_t> ids;           // sorted order -> course id
+
+    static size_t fill(const vector<uint64_t>& sorted, const FlatArray<uint32_t>& order, size_t k, size_t i,
+        vector<uint64_t>& keyOut, vector<uint32_t>& idOut, vector<uint32_t>& rankOut) {
+        if (k >= keyOut.size()) return i;
+        i = fill(sorted, order, 2 * k, i, keyOut, idOut, rankOut);
+        keyOut[k] = sorted[i]; idOut[k] = order[i]; rankOut[k] = (uint32_t)i;
+        return fill(sorted, order, 2 * k + 1, i + 1, keyOut, idOut, rankOut);
+    }
+
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    // sortedIds must outlive the index (it is shared with the catalog, not copied)
+    void build(const vector<Course>& store, const FlatArray<uint32_t>& sortedIds) {
+        const size_t n = sortedIds.size();
+        vector<uint64_t> sorted(n);
+        for (size_t i = 0; i < n; ++i) sorted[i] = packCode(store[sortedIds[i]].courseNumber());
+        vector<uint64_t> k(n + 1, 0);
+        vector<uint32_t> s(n + 1, 0), r(n + 1, 0);
+        fill(sorted, sortedIds, 1, 0, k, s, r);
+        keys = std::move(k); slotIds = std::move(s); rank = std::move(r);
+        ids.borrow(sortedIds.data(), n);
+    }
+
+    // views the arrays of a mapped snapshot; each slot array has n + 1 entries
+    void borrow(const uint64_t* k, const uint32_t* s, const uint32_t* r, const uint32_t* sortedIds, size_t n) {
+        keys.borrow(k, n + 1); slotIds.borrow(s, n + 1); rank.borrow(r, n + 1); ids.borrow(sortedIds, n);
+    }
+    const FlatArray<uint64_t>& keyArray() const { return keys; }
+    const FlatArray<uint32_t>& slotIdArray() const { return slotIds; }
+    const FlatArray<uint32_t>& rankArray() const { return rank; }
+
+    uint32_t find(string_view code, const vector<Course>& store) const {
+        const size_t n = ids.size();
+        const uint64_t key = packCode(code);
+        size_t k = 1;
+        while (k <= n) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(keys.data() + k * 16);
+#endif
+            k = 2 * k + (keys[k] < key);
+        }
+        k >>= climbBits(k);                               // lower_bound slot, 0 = past the end
+        if (k == 0 || keys[k] != key) return npos;
+        if (code.size() < 8) return slotIds[k];
+        for (size_t r = rank[k]; r < n; ++r) {          // shared 8-byte prefix: compare in full
+            string_view c = store[ids[r]].courseNumber();
+            if (packCode(c) != key) break;
+            if (CodeEqual()(c, code)) return ids[r];
+        }
+        return npos;
+    }
+
+    size_t size() const { return ids.size(); }
+    size_t memoryBytes() const { return keys.heapBytes() + slotIds.heapBytes() + rank.heapBytes(); }
+    void clear() { keys.clear(); slotIds.clear(); rank.clear(); ids.clear(); }
+};
+
+// title search (inverted index)
+
+// calls f(token) for every lowercase alphanumeric run in s, built in a reused buffer
+template <class F>
+static void forEachToken(string_view s, string& buf, F f) {
+    for (size_t i = 0; i < s.size();) {
+        while (i < s.size() && !isalnum((unsigned char)s[i])) ++i;
+        buf.clear();
+        while (i < s.size() && isalnum((unsigned char)s[i])) buf.push_back((char)tolower((unsigned char)s[i++]));
+        if (!buf.empty()) f(string_view(buf));
+    }
+}
+
+// Sorted token dictionary with one posting list (ascending course ids) per token, all in
+// flat arrays. A query is a list of words, each matched whole or, with a trailing '*',
+// as a prefix; the postings of all words are intersected, smallest list first.
+class TitleIndex {
+    string text;                                    // tokens back to back, sorted
+    vector<uint32_t> tokenAt{ 0 };                  // token t is text[tokenAt[t] .. tokenAt[t + 1])
+    vector<uint32_t> postAt{ 0 };                   // postings of t are post[postAt[t] .. postAt[t + 1])
+    vector<uint32_t> post;
+    bool built = false;
+
+    string_view token(size_t t) const { return string_view(text).substr(tokenAt[t], tokenAt[t + 1] - tokenAt[t]); }
+    size_t tokens() const { return tokenAt.size() - 1; }
+
+    // tokens [lo, hi) equal to w, or starting with it when prefix is set: two binary
+    // searches, the second comparing only the first w.size() chars for a prefix
+    pair<size_t, size_t> tokenRange(string_view w, bool prefix) const {
+        size_t lo = 0, hi = tokens();
+        while (lo < hi) { size_t m = (lo + hi) / 2; if (token(m) < w) lo = m + 1; else hi = m; }
+        size_t first = lo;
+        hi = tokens();
+        while (lo < hi) {
+            size_t m = (lo + hi) / 2;
+            string_view t = prefix ? token(m).substr(0, w.size()) : token(m);
+            if (t <= w) lo = m + 1; else hi = m;
+        }
+        return { first, lo };
+    }
+
+public:
+    bool ready() const { return built; }
+
+    void build(const vector<Course>& store) {
+        unordered_map<string, uint32_t> ids;        // token -> provisional id (first-seen order)
+        vector<pair<uint32_t, uint32_t>> hits;      // provisional token id, course id
+        string buf;
+        for (const Course& c : store) {
+            if (c.removed) continue;
+            forEachToken(c.courseTitle(), buf, [&](string_view) {
+                auto it = ids.find(buf);                // buf holds the token; no copy unless new
+                if (it == ids.end()) it = ids.emplace(buf, (uint32_t)ids.size()).first;
+                hits.emplace_back(it->second, c.id);
+                });
+        }
+        // final token ids follow alphabetical order so prefix matches are one range
+        vector<const string*> byText(ids.size());
+        for (const auto& kv : ids) byText[kv.second] = &kv.first;
+        vector<uint32_t> order(ids.size()), rankOf(ids.size());
+        for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return *byText[a] < *byText[b]; });
+        text.clear(); tokenAt.assign(1, 0);
+        for (uint32_t r = 0; r < order.size(); ++r) {
+            rankOf[order[r]] = r;
+            text += *byText[order[r]];
+            tokenAt.push_back((uint32_t)text.size());
+        }
+        // counting sort by token; hits are already in course id order within a token
+        postAt.assign(ids.size() + 1, 0);
+        for (auto& h : hits) { h.first = rankOf[h.first]; postAt[h.first + 1]++; }
+        for (size_t t = 0; t < ids.size(); ++t) postAt[t + 1] += postAt[t];
+        vector<uint32_t> fill(postAt.begin(), postAt.end() - 1);
+        post.assign(hits.size(), 0);
+        for (const auto& h : hits) post[fill[h.first]++] = h.second;
+        // a title that repeats a word posts the course twice in a row; squeeze those out
+        vector<uint32_t> packed;
+        packed.reserve(post.size());
+        for (size_t t = 0; t < ids.size(); ++t) {
+            uint32_t begin = (uint32_t)packed.size();
+            for (uint32_t i = postAt[t]; i < postAt[t + 1]; ++i)
+                if (packed.size() == begin || packed.back() != post[i]) packed.push_back(post[i]);
+            postAt[t] = begin;
+        }
+        postAt[ids.size()] = (uint32_t)packed.size();
+        post = std::move(packed);
+        built = true;
+    }
+
+    // ids of the courses whose titles contain every word of the query, ascending. Each
+    // word is a run of tokens [first, second); terms are intersected smallest first.
+    vector<uint32_t> search(string_view query) const {
+        vector<pair<size_t, size_t>> terms;
+        string buf;
+        for (size_t i = 0; i < query.size();) {
+            size_t j = query.find(' ', i);
+            if (j == string_view::npos) j = query.size();
+            string_view word = query.substr(i, j - i);
+            i = j + 1;
+            bool prefix = !word.empty() && word.back() == '*';
+            if (prefix) word.remove_suffix(1);
+            forEachToken(word, buf, [&](string_view w) { terms.push_back(tokenRange(w, prefix)); });
+        }
+        if (terms.empty()) return {};
+        auto postings = [&](const pair<size_t, size_t>& r) { return (size_t)(postAt[r.second] - postAt[r.first]); };
+        sort(terms.begin(), terms.end(), [&](const auto& a, const auto& b) { return postings(a) < postings(b); });
+
+        // a prefix word spanning several tokens is expanded into a bitmap over course ids
+        vector<uint64_t> bits;
+        auto expand = [&](const pair<size_t, size_t>& r) {
+            bits.assign(0, 0);
+            for (uint32_t k = postAt[r.first]; k < postAt[r.second]; ++k) {
+                uint32_t id = post[k];
+                if ((id >> 6) >= bits.size()) bits.resize((id >> 6) + 1, 0);
+                bits[id >> 6] |= 1ull << (id & 63);
+            }
+            };
+
+        vector<uint32_t> out;
+        if (terms[0].second - terms[0].first == 1) out.assign(post.begin() + postAt[terms[0].first], post.begin() + postAt[terms[0].second]);
+        else {
+            expand(terms[0]);
+            for (uint32_t w = 0; w < bits.size(); ++w)
+                for (uint64_t b = bits[w]; b; b &= b - 1) out.push_back(w * 64 + lowestBit(b));
+        }
+        for (size_t k = 1; k < terms.size() && !out.empty(); ++k) {
+            vector<uint32_t> next;
+            if (terms[k].second - terms[k].first == 1) {
+                const uint32_t* b = post.data() + postAt[terms[k].first];
+                const uint32_t* e = post.data() + postAt[terms[k].second];
+                if (out.size() * 16 < (size_t)(e - b))  // much shorter: binary search the long list
+                    for (uint32_t id : out) { if (binary_search(b, e, id)) next.push_back(id); }
+                else set_intersection(out.begin(), out.end(), b, e, back_inserter(next));
+            }
+            else {
+                expand(terms[k]);
+                for (uint32_t id : out)
+                    if ((id >> 6) < bits.size() && (bits[id >> 6] >> (id & 63) & 1)) next.push_back(id);
+            }
+            out = std::move(next);
+        }
+        return out;
+    }
+
+    size_t tokenCount() const { return tokens(); }
+    size_t memoryBytes() const {
+        return text.capacity() + (tokenAt.capacity() + postAt.capacity() + post.capacity()) * sizeof(uint32_t);
+    }
+    void clear() { text.clear(); tokenAt.assign(1, 0); postAt.assign(1, 0); post.clear(); built = false; }
+};
+
+// binary snapshot
+
+// File layout: SnapshotHeader, then SEC_COUNT sections, each 8-byte aligned. Every
+// section is a plain array that the catalog uses in place from the mapping.
+enum SnapSection : uint32_t {
+    SEC_TEXT,                          // chars of every code, then every title
+    SEC_CODE_OFFS,                     // uint64 x (codeCount + 1) into SEC_TEXT
+    SEC_TITLE_OFFS,                    // uint64 x (courseCount + 1) into SEC_TEXT
+    SEC_PREREQ_OFFS,                   // uint32 x (courseCount + 1) into SEC_PREREQ_IDS
+    SEC_PREREQ_IDS,                    // uint32 code ids
+    SEC_BY_CODE,                       // uint32 x courseCount, ids sorted by code
+    SEC_EYT_KEYS,                      // uint64 x (courseCount + 1)
+    SEC_EYT_SLOT_IDS,                  // uint32 x (courseCount + 1)
+    SEC_EYT_RANK,                      // uint32 x (courseCount + 1)
+    SEC_GRAPH_OFFS, SEC_GRAPH_TARGETS, // forward CSR
+    SEC_RGRAPH_OFFS, SEC_RGRAPH_TARGETS, // reverse CSR
+    SEC_MISSING,                       // uint32 pairs (course id, missing prereq id)
+    SEC_MALFORMED,                     // diagnostic lines joined with '\n'
+    SEC_COUNT
+};
+
+struct SnapshotHeader {
+    char magic[8];                     // "KMCATSNP"
+    uint32_t version;
+    uint32_t byteOrder;                // 0x01020304 as written by this machine
+    uint64_t checksum;                 // snapshotChecksum of every byte after the header
+    uint64_t fileSize;
+    uint64_t sourceSize;               // CSV the snapshot was built from (staleness check)
+    int64_t sourceTime;
+    uint32_t courseCount;
+    uint32_t codeCount;
+    uint64_t section[SEC_COUNT][2];    // byte offset, byte length
+};
+
+static const char kSnapshotMagic[8] = { 'K', 'M', 'C', 'A', 'T', 'S', 'N', 'P' };
+static const uint32_t kSnapshotVersion = 1;
+
+// 64-bit word hash over four independent lanes so it runs near memory bandwidth
+static uint64_t snapshotChecksum(const char* p, size_t n) {
+    const uint64_t M = 0x9E3779B97F4A7C15ull;
+    uint64_t h[4] = { n, n ^ 0x1234567u, n ^ 0x89ABCDEu, n ^ 0xF0F0F0Fu };
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        for (int l = 0; l < 4; ++l) {
+            uint64_t w;
+            memcpy(&w, p + i + 8 * l, 8);
+            h[l] = (h[l] ^ w) * M;
+            h[l] ^= h[l] >> 32;
+        }
+    }
+    uint64_t out = h[0] ^ (h[1] * 3) ^ (h[2] * 5) ^ (h[3] * 7);
+    for (; i < n; ++i) out = (out ^ (unsigned char)p[i]) * M;
+    return out ^ (out >> 29);
+}
+
+// size and modification time of the source CSV, used to detect a stale snapshot
+static bool sourceStamp(const string& path, uint64_t& size, int64_t& time) {
+    error_code ec;
+    auto sz = filesystem::file_size(path, ec);
+    if (ec) return false;
+    auto t = filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    size = (uint64_t)sz;
+    time = (int64_t)t.time_since_epoch().count();
+    return true;
+}
+
+// index policies
+
+// Which lookup structures a catalog builds, fixed at compile time. A catalog loads,
+// stores and keeps up to date only the indexes its policy names, and find() resolves to
+// the fastest of them with no runtime dispatch. The hash map doubles as the edit index:
+// a catalog whose policy leaves it out builds it on the first edit.
+template <bool Hash, bool Eytzinger, bool Avl, bool Bst>
+struct IndexPolicy {
+    static constexpr bool hash = Hash;
+    static constexpr bool eytzinger = Eytzinger;
+    static constexpr bool avl = Avl;
+    static constexpr bool bst = Bst;
+    static constexpr bool sorted = Eytzinger || Avl || Bst;    // built from byCode, so the load sorts
+};
+
+using AllIndexes = IndexPolicy<true, true, true, true>;     // menu and benchmarks
+using HashIndex = IndexPolicy<true, false, false, false>;   // serving: --batch and --watch
+using StaticIndex = IndexPolicy<false, true, false, false>;
+using AvlIndex = IndexPolicy<false, false, true, false>;
+using BstIndex = IndexPolicy<false, false, false, true>;
+
+// course catalog structure
+
+template <class Indexes = AllIndexes>
+class BasicCourseCatalog {
+public:
+    // the only copy of each course; index = id. Only growStore() resizes it, and it
+    // re-points the trees when it does.
+    vector<Course> courses;
+
+    // baselines with alternatives (all refer into courses); only those named by Indexes are built
+    BinarySearchTree bst;                               // original structure
+    AVLTree avl;                                        // balanced tree
+    unordered_map<string_view, uint32_t, CodeHash, CodeEqual> hmap; // code -> id, any case (keys view into codes)
+    FlatArray<uint32_t> byCode;                         // course ids sorted by course number
+    EytzingerIndex sindex;                              // read-only packed-key index
+    TitleIndex titleIndex;                              // title words -> course ids; built on first search
+
+    CodeTable codes;                                    // course code <-> dense id
+
+    // what the Course views point into: pools for a CSV load, or a mapped snapshot
+    string titlePool;
+    vector<uint32_t> prereqPool;
+    unique_ptr<MappedFile> snapshotFile;
+
+    // Graph: prereq id -> dependent course ids, and the reverse (course -> its known prereqs)
+    CsrGraph graph;
+    CsrGraph rgraph;
+    PrereqClosure closure;                              // lazy, over rgraph; reset on every load
+    CourseLevels levels;                                // lazy, over graph; see courseLevels()
+    bool levelsReady = false;
+    EligibilityEngine eligibilityEngine;                // lazy, over the prerequisite lists; see eligibility()
+    bool eligibilityReady = false;
+    ImpactSearch impactSearch;                          // scratch for impact()
+
+    // diagnostics
+    vector<string> malformedRows;
+    vector<pair<uint32_t, uint32_t>> missingPrereqs;     // course id, missing prereq id
+
+    bool loaded = false;
+    bool edited = false;                                // changed since the last load (see addCourse)
+    bool quiet = false;                                 // no load report (background reloads)
+    string sourceFile = "CS 300 ABCU_Advising_Program_Input.csv";
+    string snapshotPath;                                // non-empty: try this snapshot before the CSV
+    unsigned loadThreads = 1;                           // >1 enables the parallel load mode
+    unique_ptr<ThreadPool> pool;
+    LoadStats stats;                                    // per-phase timings of the last load, when enabled
+
+    ThreadPool* loadPool() {
+        if (loadThreads <= 1) return nullptr;
+        if (!pool || pool->size() != loadThreads) pool = make_unique<ThreadPool>(loadThreads);
+        return pool.get();
+    }
+
+    void clear() {
+        courses.clear();
+        hmap.clear();
+        byCode.clear();
+        graph.clear();
+        rgraph.clear();
+        closure.reset(nullptr);
+        levelsReady = false;
+        eligibilityReady = false;
+        dag.clear();
+        editText.clear();
+        editPrereqs.clear();
+        absent = 0;
+        edited = graphStale = false;
+        codes.clear();
+        malformedRows.clear();
+        missingPrereqs.clear();
+        loaded = false;
+        // O(1): rewinds the node pools, which keep their blocks for the next load
+        bst.clear();
+        avl.clear();
+        sindex.clear();
+        titleIndex.clear();
+        titlePool.clear();
+        prereqPool.clear();
+        snapshotFile.reset();                           // last: everything above may view it
+    }
+
+    void reportLoad(const char* from) const {
+        if (quiet) return;
+        cout << "Courses loaded (" << courses.size() << ")" << from << ".\n";
+        if (!malformedRows.empty() || !missingPrereqs.empty()) {
+            cout << "\n=== CSV Warnings ===\n";
+            for (const auto& m : malformedRows) cout << m << '\n';
+            for (const auto& miss : missingPrereqs)
+                cout << "Missing prereq: " << codes.name(miss.first) << " requires " << codes.name(miss.second) << " (not found)\n";
+            cout << "====================\n\n";
+        }
+    }
+
+    // Menu entry point: a valid, fresh snapshot if one is configured, otherwise the CSV
+    // (and then the snapshot is rewritten so the next start is fast).
+    bool loadAll() {
+        if (snapshotPath.empty()) return loadAll(sourceFile);
+        string why;
+        if (loadSnapshot(snapshotPath, why)) { reportLoad(" from snapshot"); return true; }
+        if (!quiet) cout << "Snapshot " << snapshotPath << " not used (" << why << "); loading CSV.\n";
+        if (!loadAll(sourceFile)) return false;
+        if (saveSnapshot(snapshotPath) && !quiet) cout << "Snapshot written to " << snapshotPath << ".\n";
+        return true;
+    }
+
+    // Load CSV, build all structures, and validate
+    bool loadAll(const string& filename) {
+        stats.begin();
+        bool ok;
+        {
+            LoadStats::Scope total(stats, "total");
+            ok = loadCsv(filename);
+        }
+        stats.end();
+        return ok;
+    }
+
+    bool loadCsv(const string& filename) {
+        clear();
+        LoadStats::Scope phase(stats, "read file");
+        MappedFile file(filename);
+        if (!file.ok()) {
+            if (!quiet) cout << "Error opening file: " << filename << '\n';
+            return false;
+        }
+        if (stats.enabled) {                            // page the file in here, so "tokenize" is CPU only
+            unsigned char sum = 0;
+            for (size_t i = 0; i < file.view().size(); i += 4096) sum += (unsigned char)file.view()[i];
+            volatile unsigned char sink = sum;
+            (void)sink;
+        }
+
+        phase.next("tokenize");
+        ThreadPool* tp = loadPool();
+        vector<CsvRow> rows;
+        if (tp) parseCatalogParallel(file.view(), *tp, rows, malformedRows);
+        else parseCatalogText(file.view(), 1, rows, malformedRows);
+
+        phase.next("intern codes");
+        // intern course numbers first so courses own ids [0, n); a repeated number keeps
+        // its first id and the later row wins (same as the hash index always did)
+        string key;
+        vector<size_t> rowOf;                           // id -> row that defines it
+        codes.reserve(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            uint32_t id = codes.intern(upperInto(rows[i].number, key));
+            if (id == rowOf.size()) { rowOf.push_back(i); continue; }
+            malformedRows.push_back("Line " + to_string(rows[i].line) + ": duplicate course number " + string(key)
+                + " (replaces line " + to_string(rows[rowOf[id]].line) + ")");
+            rowOf[id] = i;
+        }
+
+        // resolve prerequisite codes to ids; unknown codes get ids past the course range.
+        // Titles and prereq ids go into two pools sized up front, then the views are set.
+        phase.next("course records");
+        const size_t count = rowOf.size();
+        size_t titleBytes = 0;
+        for (size_t row : rowOf) titleBytes += rows[row].title.size();
+        titlePool.reserve(titleBytes);
+        // short prerequisite lists go straight into the record, longer ones to the pool
+        vector<uint32_t> list;
+        vector<pair<uint32_t, size_t>> spilled;         // course id, start in prereqPool
+        courses.resize(count);
+        for (uint32_t id = 0; id < count; ++id) {
+            const CsvRow& r = rows[rowOf[id]];
+            Course& c = courses[id];
+            c.id = id;
+            c.setCourseNumber(codes.name(id));
+            c.setCourseTitle(string_view(titlePool.data() + titlePool.size(), r.title.size()));
+            titlePool.append(r.title);
+            list.clear();
+            forEachField(r.prereqs, [&](string_view p) { list.push_back(codes.intern(upperInto(p, key))); });
+            if (list.size() <= Course::PREREQ_INLINE) c.setPrerequisites({ list.data(), list.data() + list.size() });
+            else {
+                spilled.emplace_back(id, prereqPool.size());
+                prereqPool.insert(prereqPool.end(), list.begin(), list.end());
+            }
+        }
+        for (size_t i = 0; i < spilled.size(); ++i) {
+            size_t end = i + 1 < spilled.size() ? spilled[i + 1].second : prereqPool.size();
+            courses[spilled[i].first].setPrerequisites({ prereqPool.data() + spilled[i].second, prereqPool.data() + end });
+        }
+
+        // build structures; each job owns a different member so they can run concurrently
+        phase.next(tp ? "index builds (parallel)" : "index builds");
+        const uint32_t n = (uint32_t)courses.size();
+        runAll(tp, {
+            [&] {
+                if constexpr (Indexes::hash) { LoadStats::Scope job(stats, "  hmap", true); buildHash(); }
+            },
+            [&] {
+                // sort once, then the trees and the static index are built balanced in linear time
+                if constexpr (Indexes::sorted) {
+                    LoadStats::Scope job(stats, "  sort by code", true);
+                    byCode = sortByCode();
+                    if constexpr (Indexes::bst) { job.next("  bst"); bst.build(courses, byCode); }
+                    if constexpr (Indexes::avl) { job.next("  avl"); avl.build(courses, byCode); }
+                    if constexpr (Indexes::eytzinger) { job.next("  eytzinger"); sindex.build(courses, byCode); }
+                }
+            },
+            [&] {
+                // build graph (prereq -> course) and record missing prereqs
+                LoadStats::Scope job(stats, "  graph", true);
+                vector<pair<uint32_t, uint32_t>> edges;
+                for (const auto& c : courses) {
+                    for (uint32_t p : c.prerequisites()) {
+                        if (p >= n) missingPrereqs.emplace_back(c.id, p);
+                        else edges.emplace_back(p, c.id);
+                    }
+                }
+                graph = CsrGraph::build(n, edges);
+                rgraph = graph.reversed();
+            },
+            });
+        phase.done();
+
+        closure.reset(&rgraph);
+        levelsReady = false;
+        loaded = true;
+        reportLoad("");
+        return true;
+    }
+
+    void buildHash() {
+        hmap.reserve(courses.size());
+        for (const auto& c : courses) if (!c.removed) hmap.emplace(codes.name(c.id), c.id);
+    }
+
+    // ids of the live courses in course-number order
+    vector<uint32_t> sortByCode() const {
+        vector<uint32_t> order;
+        order.reserve(courseCount());
+        for (const auto& c : courses) if (!c.removed) order.push_back(c.id);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return courses[a].courseNumber() < courses[b].courseNumber(); });
+        return order;
+    }
+
+    // Writes the loaded catalog as a versioned, checksummed snapshot (see SnapSection).
+    // Refused after edits: the snapshot would claim to match a CSV that says otherwise.
+    bool saveSnapshot(const string& path) const {
+        if (!loaded || edited) return false;
+        const uint32_t n = (uint32_t)courses.size();
+        const uint32_t codeCount = (uint32_t)codes.size();
+        SnapshotHeader h{};
+        memcpy(h.magic, kSnapshotMagic, sizeof h.magic);
+        h.version = kSnapshotVersion;
+        h.byteOrder = 0x01020304;
+        h.courseCount = n;
+        h.codeCount = codeCount;
+        sourceStamp(sourceFile, h.sourceSize, h.sourceTime);
+
+        string body;
+        auto put = [&](SnapSection s, const void* p, size_t bytes) {
+            body.append((8 - (sizeof h + body.size()) % 8) % 8, '\0');
+            h.section[s][0] = sizeof h + body.size();
+            h.section[s][1] = bytes;
+            if (bytes) body.append((const char*)p, bytes);
+            };
+        auto putVec = [&](SnapSection s, const auto& v) { put(s, v.data(), v.size() * sizeof(v[0])); };
+
+        string text;
+        vector<uint64_t> codeOffs{ 0 }, titleOffs;
+        for (uint32_t i = 0; i < codeCount; ++i) { text.append(codes.name(i)); codeOffs.push_back(text.size()); }
+        titleOffs.push_back(text.size());
+        for (const auto& c : courses) { text.append(c.courseTitle()); titleOffs.push_back(text.size()); }
+        vector<uint32_t> prereqOffs{ 0 }, prereqIds;
+        for (const auto& c : courses) {
+            prereqIds.insert(prereqIds.end(), c.prerequisites().begin(), c.prerequisites().end());
+            prereqOffs.push_back((uint32_t)prereqIds.size());
+        }
+        vector<uint32_t> missing;
+        for (const auto& m : missingPrereqs) { missing.push_back(m.first); missing.push_back(m.second); }
+        string malformed;
+        for (const auto& m : malformedRows) malformed.append(m).push_back('\n');
+
+        putVec(SEC_TEXT, text);
+        putVec(SEC_CODE_OFFS, codeOffs);
+        putVec(SEC_TITLE_OFFS, titleOffs);
+        putVec(SEC_PREREQ_OFFS, prereqOffs);
+        putVec(SEC_PREREQ_IDS, prereqIds);
+        // the file always carries the static index, whatever this catalog's policy built
+        FlatArray<uint32_t> order;
+        EytzingerIndex builtIndex;
+        if constexpr (!Indexes::sorted) order = sortByCode();
+        if constexpr (!Indexes::eytzinger) builtIndex.build(courses, Indexes::sorted ? byCode : order);
+        const EytzingerIndex& six = Indexes::eytzinger ? sindex : builtIndex;
+        putVec(SEC_BY_CODE, Indexes::sorted ? byCode : order);
+        putVec(SEC_EYT_KEYS, six.keyArray());
+        putVec(SEC_EYT_SLOT_IDS, six.slotIdArray());
+        putVec(SEC_EYT_RANK, six.rankArray());
+        putVec(SEC_GRAPH_OFFS, graph.offsets);
+        putVec(SEC_GRAPH_TARGETS, graph.targets);
+        putVec(SEC_RGRAPH_OFFS, rgraph.offsets);
+        putVec(SEC_RGRAPH_TARGETS, rgraph.targets);
+        putVec(SEC_MISSING, missing);
+        putVec(SEC_MALFORMED, malformed);
+
+        h.fileSize = sizeof h + body.size();
+        h.checksum = snapshotChecksum(body.data(), body.size());
+
+        string tmp = path + ".tmp";                     // write aside, then rename over the old one
+        {
+            ofstream out(tmp, ios::binary | ios::trunc);
+            if (!out) { if (!quiet) cout << "Error writing snapshot: " << tmp << '\n'; return false; }
+            out.write((const char*)&h, sizeof h);
+            out.write(body.data(), (streamsize)body.size());
+            if (!out) { if (!quiet) cout << "Error writing snapshot: " << tmp << '\n'; return false; }
+        }
+        error_code ec;
+        filesystem::rename(tmp, path, ec);
+        if (ec) { if (!quiet) cout << "Error writing snapshot: " << path << '\n'; return false; }
+        return true;
+    }
+
+    // Maps a snapshot and points every flat structure straight into it. Only the Course
+    // view records and the tree nodes are rebuilt (linear, no parsing or sorting); the
+    // hash map is left for the benchmark suite to build, and find() serves lookups from the
+    // mapped static index meanwhile. Returns false with a reason when the file is missing,
+    // corrupt or stale.
+    bool loadSnapshot(const string& path, string& why) {
+        stats.begin();
+        bool ok;
+        {
+            LoadStats::Scope total(stats, "total");
+            ok = mapSnapshot(path, why);
+        }
+        stats.end();
+        return ok;
+    }
+
+    bool mapSnapshot(const string& path, string& why) {
+        LoadStats::Scope phase(stats, "map + verify");
+        auto file = make_unique<MappedFile>(path);
+        if (!file->ok()) { why = "cannot open"; return false; }
+        string_view data = file->view();
+        SnapshotHeader h;
+        if (data.size() < sizeof h) { why = "truncated"; return false; }
+        memcpy(&h, data.data(), sizeof h);
+        if (memcmp(h.magic, kSnapshotMagic, sizeof h.magic) != 0) { why = "not a snapshot"; return false; }
+        if (h.version != kSnapshotVersion || h.byteOrder != 0x01020304) { why = "unsupported version"; return false; }
+        if (h.fileSize != data.size()) { why = "truncated"; return false; }
+        for (const auto& s : h.section) {
+            if (s[0] % 8 != 0 || s[0] < sizeof h || s[0] > data.size() || s[1] > data.size() - s[0]) {
+                why = "bad section table"; return false;
+            }
+        }
+        if (snapshotChecksum(data.data() + sizeof h, data.size() - sizeof h) != h.checksum) { why = "checksum mismatch"; return false; }
+        uint64_t srcSize; int64_t srcTime;
+        if (sourceStamp(sourceFile, srcSize, srcTime) && (srcSize != h.sourceSize || srcTime != h.sourceTime)) {
+            why = "stale: " + sourceFile + " changed"; return false;
+        }
+
+        const uint32_t n = h.courseCount;
+        // typed view of a section; nullptr unless it holds exactly `count` elements
+        auto arr = [&](auto tag, SnapSection s, size_t count) {
+            using T = decltype(tag);
+            const T* p = (const T*)(data.data() + h.section[s][0]);
+            return h.section[s][1] == count * sizeof(T) ? p : nullptr;
+            };
+        auto count = [&](SnapSection s, size_t elem) { return (size_t)(h.section[s][1] / elem); };
+        const char* text = data.data() + h.section[SEC_TEXT][0];
+        const uint64_t* codeOffs = arr(uint64_t(), SEC_CODE_OFFS, (size_t)h.codeCount + 1);
+        const uint64_t* titleOffs = arr(uint64_t(), SEC_TITLE_OFFS, (size_t)n + 1);
+        const uint32_t* prereqOffs = arr(uint32_t(), SEC_PREREQ_OFFS, (size_t)n + 1);
+        const uint32_t* prereqIds = arr(uint32_t(), SEC_PREREQ_IDS, count(SEC_PREREQ_IDS, 4));
+        const uint32_t* sorted = arr(uint32_t(), SEC_BY_CODE, n);
+        const uint64_t* eKeys = arr(uint64_t(), SEC_EYT_KEYS, (size_t)n + 1);
+        const uint32_t* eIds = arr(uint32_t(), SEC_EYT_SLOT_IDS, (size_t)n + 1);
+        const uint32_t* eRank = arr(uint32_t(), SEC_EYT_RANK, (size_t)n + 1);
+        const uint32_t* gOffs = arr(uint32_t(), SEC_GRAPH_OFFS, (size_t)n + 1);
+        const uint32_t* rOffs = arr(uint32_t(), SEC_RGRAPH_OFFS, (size_t)n + 1);
+        const uint32_t* gTargets = arr(uint32_t(), SEC_GRAPH_TARGETS, count(SEC_GRAPH_TARGETS, 4));
+        const uint32_t* rTargets = arr(uint32_t(), SEC_RGRAPH_TARGETS, count(SEC_RGRAPH_TARGETS, 4));
+        const uint32_t* missing = arr(uint32_t(), SEC_MISSING, count(SEC_MISSING, 4));
+        // the count-sized views are null as well when a length is not a whole number of ids
+        if (!codeOffs || !titleOffs || !prereqOffs || !sorted || !eKeys || !eIds || !eRank || !gOffs || !rOffs
+            || !prereqIds || !gTargets || !rTargets || !missing
+            || h.codeCount < n || codeOffs[h.codeCount] > titleOffs[0] || titleOffs[n] > h.section[SEC_TEXT][1]
+            || prereqOffs[n] > count(SEC_PREREQ_IDS, 4)
+            || gOffs[n] != count(SEC_GRAPH_TARGETS, 4) || rOffs[n] != count(SEC_RGRAPH_TARGETS, 4)) {
+            why = "inconsistent sections"; return false;
+        }
+        // The checksum only shows the bytes are the ones written; a buggy or older writer
+        // can still have written offsets or ids that would read out of bounds.
+        auto ascending = [](const auto* offs, size_t count) {
+            for (size_t i = 1; i < count; ++i) if (offs[i] < offs[i - 1]) return false;
+            return true;
+            };
+        auto below = [](const uint32_t* ids, size_t count, uint64_t limit) {
+            for (size_t i = 0; i < count; ++i) if (ids[i] >= limit) return false;
+            return true;
+            };
+        bool missingOk = true;
+        for (size_t i = 0; i + 1 < count(SEC_MISSING, 4); i += 2) missingOk &= missing[i] < n && missing[i + 1] < h.codeCount;
+        if (!ascending(codeOffs, (size_t)h.codeCount + 1) || !ascending(titleOffs, (size_t)n + 1) || !ascending(prereqOffs, (size_t)n + 1)
+            || !ascending(gOffs, (size_t)n + 1) || !ascending(rOffs, (size_t)n + 1)
+            || !below(prereqIds, prereqOffs[n], h.codeCount) || !below(sorted, n, n)
+            || !below(eIds + 1, n, n) || !below(eRank + 1, n, n)
+            || !below(gTargets, count(SEC_GRAPH_TARGETS, 4), n) || !below(rTargets, count(SEC_RGRAPH_TARGETS, 4), n) || !missingOk) {
+            why = "offsets or ids out of range"; return false;
+        }
+
+        phase.next("course records");
+        clear();
+        vector<string_view> names(h.codeCount);
+        for (uint32_t i = 0; i < h.codeCount; ++i) names[i] = string_view(text + codeOffs[i], codeOffs[i + 1] - codeOffs[i]);
+        codes.adopt(std::move(names));
+        courses.resize(n);
+        for (uint32_t id = 0; id < n; ++id) {
+            Course& c = courses[id];
+            c.id = id;
+            c.setCourseNumber(codes.name(id));
+            c.setCourseTitle(string_view(text + titleOffs[id], titleOffs[id + 1] - titleOffs[id]));
+            c.setPrerequisites({ prereqIds + prereqOffs[id], prereqIds + prereqOffs[id + 1] });
+        }
+        byCode.borrow(sorted, n);
+        if constexpr (Indexes::eytzinger) sindex.borrow(eKeys, eIds, eRank, sorted, n);
+        graph.borrow(gOffs, n, gTargets, count(SEC_GRAPH_TARGETS, 4));
+        rgraph.borrow(rOffs, n, rTargets, count(SEC_RGRAPH_TARGETS, 4));
+
+        for (size_t i = 0; i + 1 < count(SEC_MISSING, 4); i += 2) missingPrereqs.emplace_back(missing[i], missing[i + 1]);
+        string_view bad(data.data() + h.section[SEC_MALFORMED][0], h.section[SEC_MALFORMED][1]);
+        forEachLine(bad, [&](string_view line) { malformedRows.emplace_back(line); });
+
+        if constexpr (Indexes::hash && !Indexes::eytzinger) { phase.next("hmap"); buildHash(); }
+        if constexpr (Indexes::bst) { phase.next("bst"); bst.build(courses, byCode); }
+        if constexpr (Indexes::avl) { phase.next("avl"); avl.build(courses, byCode); }
+        phase.done();
+        snapshotFile = std::move(file);
+        closure.reset(&rgraph);
+        levelsReady = false;
+        loaded = true;
+        return true;
+    }
+
+    // search helpers
+
+    // Production lookup, picked at compile time from the policy: the hash index (when it
+    // has been built), else the static index, else a tree, else a scan. Edits drop the
+    // static index and always build the hash map, so an edited catalog uses that.
+    // Every find takes the code in any case and allocates nothing.
+    const Course* find(string_view key) const {
+        if constexpr (Indexes::hash && Indexes::eytzinger) return edited || hmap.size() == courses.size() ? findHash(key) : findStatic(key);
+        else if constexpr (Indexes::hash) return findHash(key);
+        else if constexpr (Indexes::eytzinger) return edited ? findHash(key) : findStatic(key);
+        else if constexpr (Indexes::avl) return findAVL(key);
+        else if constexpr (Indexes::bst) return findBST(key);
+        else return edited ? findHash(key) : findVector(key);
+    }
+    const Course* findVector(string_view key) const { // linear scan over the store itself
+        for (const auto& c : courses) if (!c.removed && CodeEqual()(c.courseNumber(), key)) return &c;
+        return nullptr;
+    }
+    const Course* findHash(string_view key) const {
+        auto it = hmap.find(key);
+        return it == hmap.end() ? nullptr : &courses[it->second];
+    }
+    const Course* findBST(string_view key) const {
+        static_assert(Indexes::bst, "this catalog's index policy has no BST");
+        return bst.search(key);
+    }
+    const Course* findAVL(string_view key) const {
+        static_assert(Indexes::avl, "this catalog's index policy has no AVL tree");
+        return avl.search(key);
+    }
+    const Course* findStatic(string_view key) const {
+        static_assert(Indexes::eytzinger, "this catalog's index policy has no static index");
+        uint32_t id = sindex.find(key, courses);
+        return id == EytzingerIndex::npos ? nullptr : &courses[id];
+    }
+
+    // search
+
+    // Live course ids in course-number order. Rebuilt when an add or remove has cleared
+    // byCode, or when the policy had no sorted index to build it for at load.
+    const FlatArray<uint32_t>& codeOrder() {
+        if (byCode.size() != courseCount()) {
+            if constexpr (Indexes::bst) {
+                vector<uint32_t> order;
+                order.reserve(courseCount());
+                bst.forEachInOrder([&](const Course& c) { order.push_back(c.id); });
+                byCode = std::move(order);
+            }
+            else byCode = sortByCode();
+        }
+        return byCode;
+    }
+
+    // Courses whose number starts with `prefix` (case-insensitive): a contiguous run of
+    // byCode found with two binary searches. Valid until the next add/remove.
+    IdRange findPrefix(string_view prefix) {
+        codeOrder();
+        return prefixRange(trimView(prefix));
+    }
+    // same once codeOrder() is current (no rebuild, so safe on a shared snapshot)
+    IdRange prefixRange(string_view prefix) const {
+        auto key = [&](uint32_t id) { return courses[id].courseNumber().substr(0, prefix.size()); };
+        const uint32_t* lo = lower_bound(byCode.begin(), byCode.end(), prefix, [&](uint32_t id, string_view p) { return compareCode(key(id), p) < 0; });
+        const uint32_t* hi = upper_bound(lo, byCode.end(), prefix, [&](string_view p, uint32_t id) { return compareCode(p, key(id)) < 0; });
+        return { lo, hi };
+    }
+
+    // ids of courses whose titles contain every word of `query` ("word*" matches a prefix)
+    vector<uint32_t> searchTitles(string_view query) {
+        if (!titleIndex.ready()) titleIndex.build(courses);
+        return titleIndex.search(query);
+    }
+
+    // output boundary: id -> course code
+    string_view codeOf(uint32_t id) const { return codes.name(id); }
+
+    // graph algos
+
+    // DFS cycle detection; after edits, O(1) while the online order is being kept
+    bool hasCycle() {
+        if (edited && dag.isOrdered()) return false;
+        syncGraph();
+        return csrHasCycle(graph);
+    }
+
+    // one offending cycle as course ids (prereq -> dependent order), empty if none
+    vector<uint32_t> findCycle() { syncGraph(); return csrFindCycle(graph); }
+
+    // every cyclic group of courses (strongly connected components), one linear pass
+    vector<vector<uint32_t>> cyclicGroups() { syncGraph(); return csrCyclicComponents(graph); }
+
+    // Kahn's algorithm for topological order (course ids; resolve with codeOf). After
+    // edits the online order is returned as is when there is one.
+    vector<uint32_t> topoOrder(bool& ok) {
+        if (!edited) return csrTopoOrder(graph, ok);
+        vector<uint32_t> order;
+        if (dag.isOrdered()) { ok = true; order = dag.order(); }
+        else { syncGraph(); order = csrTopoOrder(graph, ok); }
+        order.erase(remove_if(order.begin(), order.end(), [&](uint32_t id) { return !isCourse(id); }), order.end());
+        return order;
+    }
+
+    // Every course that has to be taken before `id`, directly or indirectly (ids in id
+    // order), and the number of courses in its longest prerequisite chain. Memoized.
+    using PrereqChain = PrereqClosure::Chain;
+    PrereqChain allPrereqs(uint32_t id) {
+        syncGraph();
+        return closure.chain(id);
+    }
+
+    // longest-chain levels of every course, built on first use (on the load pool when
+    // there is one) and kept until the next load or edit
+    const CourseLevels& courseLevels() {
+        syncGraph();
+        if (!levelsReady) {
+            if (absent) levels = csrLevels(graph, [&](uint32_t v) { return isCourse(v); }, loadPool());
+            else levels = csrLevels(graph, [](uint32_t) { return true; }, loadPool()); // every vertex is a course
+            levelsReady = true;
+        }
+        return levels;
+    }
+
+    // one longest prerequisite chain in the catalog, first course first
+    vector<uint32_t> criticalPath() { return courseLevels().criticalPath(graph); }
+
+    // Terms for a student aiming at `targets` (empty: every course) who has passed
+    // `completed`. Everything below a target is planned too; everything below a
+    // completed course counts as passed.
+    SemesterPlan planSemesters(const vector<uint32_t>& targets, const vector<uint32_t>& completed, uint32_t maxPerTerm) {
+        const CourseLevels& lv = courseLevels();
+        unordered_set<uint32_t> done;
+        for (uint32_t id : completed) {
+            if (!done.insert(id).second) continue;
+            for (uint32_t p : closure.chain(id).ids) done.insert(p);
+        }
+        vector<uint32_t> wanted;
+        auto want = [&](uint32_t id) { if (isCourse(id) && !done.count(id)) wanted.push_back(id); };
+        if (targets.empty()) for (uint32_t id = 0; id < courses.size(); ++id) want(id);
+        for (uint32_t id : targets) {
+            want(id);
+            for (uint32_t p : closure.chain(id).ids) want(p);
+        }
+        return scheduleTerms(graph, lv, std::move(wanted), maxPerTerm);
+    }
+
+    // what students with these transcripts can take next, built on first use and kept
+    // until the next load or edit (see EligibilityEngine)
+    EligibilityEngine& eligibility() {
+        if (!eligibilityReady) {
+            eligibilityEngine.build(courses, codes.size());
+            eligibilityReady = true;
+        }
+        return eligibilityEngine;
+    }
+
+    // Calls f(i, ids) with every course downstream of queries[i] (source ids), i.e. all
+    // that need a source directly or not; see ImpactSearch.
+    template <class F>
+    void impact(const vector<vector<uint32_t>>& queries, F f, BfsMode mode = BfsMode::Auto) {
+        syncGraph();
+        impactSearch.run(graph, rgraph, queries, f, mode);
+    }
+
+    // comma separated course numbers -> ids; false with the first unknown one in `err`
+    bool resolveCodes(string_view list, vector<uint32_t>& ids, string& err) {
+        bool ok = true;
+        forEachField(list, [&](string_view code) {
+            if (!ok) return;
+            const Course* c = find(code);
+            if (c) ids.push_back(c->id);
+            else { err = upperCopy(code) + ": Course not found."; ok = false; }
+            });
+        return ok;
+    }
+
+    // benchmarking the parse phase: original stream parser vs mapped tokenizer (serial and parallel)
+    void benchmarkLoad(size_t reps = 5) const {
+        using clock = chrono::steady_clock;
+        size_t rows = 0;
+        // parse() stages every row and returns the row count (-1 if the file cannot be opened)
+        auto bench = [&](const string& name, auto parse) {
+            double best = 1e300;
+            for (size_t r = 0; r < reps; ++r) {
+                auto t0 = clock::now();
+                long long n = parse();
+                auto t1 = clock::now();
+                if (n < 0) return;
+                best = min(best, chrono::duration<double, milli>(t1 - t0).count());
+                rows = (size_t)n;
+            }
+            cout << name << " best: " << best << " ms  (rows: " << rows << ")\n";
+            };
+
+        cout << "Benchmarking CSV parse of " << sourceFile << " (best of " << reps << ")...\n";
+        bench("Stream (getline/stringstream)", [this]() -> long long {
+            ifstream in(sourceFile);
+            if (!in.is_open()) { cout << "Error opening file: " << sourceFile << '\n'; return -1; }
+            vector<StreamRow> out; vector<string> bad;
+            parseCatalogStream(in, out, bad);
+            return (long long)out.size();
+            });
+        bench("Mapped (string_view)", [this]() -> long long {
+            MappedFile f(sourceFile);
+            if (!f.ok()) { cout << "Error opening file: " << sourceFile << '\n'; return -1; }
+            vector<CsvRow> out; vector<string> bad;
+            parseCatalogText(f.view(), 1, out, bad);
+            return (long long)out.size();
+            });
+        unsigned hw = max({ 2u, thread::hardware_concurrency(), loadThreads });
+        for (unsigned t = 2; t <= hw; t *= 2) {
+            ThreadPool tp(t);
+            bench("Mapped parallel (" + to_string(t) + " threads)", [&]() -> long long {
+                MappedFile f(sourceFile);
+                if (!f.ok()) { cout << "Error opening file: " << sourceFile << '\n'; return -1; }
+                vector<CsvRow> out; vector<string> bad;
+                parseCatalogParallel(f.view(), tp, out, bad);
+                return (long long)out.size();
+                });
+        }
+        cout << '\n';
+    }
+
+    // incremental edits
+
+    // Courses and prerequisite edges can be added, changed and removed one at a time. The
+    // hash map, the policy's trees and the DynamicDag (with its online topological order) are
+    // updated in place on every edit. The read-only arrays (byCode, the static index, the
+    // CSR graphs and the closure memo) are rebuilt only when something next needs them.
+    // A removed course keeps its id as a tombstone (Course::removed) so ids stay dense.
+
+    bool isCourse(uint32_t id) const { return id < courses.size() && !courses[id].removed; }
+    size_t courseCount() const { return courses.size() - absent; }
+
+    bool addCourse(string_view code, string_view title, const vector<string_view>& prereqs, string& err) {
+        string key = upperCopy(trimView(code));
+        title = trimView(title);
+        if (key.empty() || title.empty()) { err = "course number and title are required"; return false; }
+        beginEdit();
+        uint32_t id = codes.intern(key);
+        if (isCourse(id)) { err = key + " already exists"; return false; }
+        growStore(id);
+
+        // rows that named this code as a missing prereq now get real edges
+        vector<uint32_t> dependents;
+        for (const auto& m : missingPrereqs) if (m.second == id) dependents.push_back(m.first);
+        vector<uint32_t> list = internPrereqs(prereqs);
+        vector<pair<uint32_t, uint32_t>> edges;
+        for (uint32_t p : list) if (p == id || isCourse(p)) edges.emplace_back(p, id);
+        for (uint32_t d : dependents) edges.emplace_back(id, d);
+        if (!addEdges(edges, err)) return false;
+
+        Course& c = courses[id];
+        c.removed = false;
+        --absent;
+        c.setCourseTitle(editText.emplace_back(title));
+        setPrereqs(id, std::move(list));
+        missingPrereqs.erase(remove_if(missingPrereqs.begin(), missingPrereqs.end(),
+            [&](const pair<uint32_t, uint32_t>& m) { return m.second == id; }), missingPrereqs.end());
+        for (uint32_t p : c.prerequisites()) if (!isCourse(p)) missingPrereqs.emplace_back(id, p);
+        hmap.emplace(codes.name(id), id);             // keys must not point into the records
+        if constexpr (Indexes::bst) bst.insert(c);
+        if constexpr (Indexes::avl) avl.insert(c);
+        graphStale = true;                              // new vertices even when no edges changed
+        byCode.clear();
+        titleIndex.clear();
+        return true;
+    }
+
+    bool removeCourse(string_view code, string& err) {
+        beginEdit();
+        uint32_t id = 0;
+        if (!lookupId(code, id, err)) return false;
+        Course& c = courses[id];
+        for (uint32_t p : vector<uint32_t>(dag.in[id])) dag.removeEdge(p, id);
+        for (uint32_t d : vector<uint32_t>(dag.out[id])) {
+            dag.removeEdge(id, d);
+            missingPrereqs.emplace_back(d, id);         // d still lists this code
+        }
+        missingPrereqs.erase(remove_if(missingPrereqs.begin(), missingPrereqs.end(),
+            [&](const pair<uint32_t, uint32_t>& m) { return m.first == id; }), missingPrereqs.end());
+        if constexpr (Indexes::bst) bst.remove(c.courseNumber());
+        if constexpr (Indexes::avl) avl.remove(c.courseNumber());
+        hmap.erase(c.courseNumber());
+        editPrereqs.erase(id);
+        c.setCourseTitle({});
+        c.setPrerequisites({ nullptr, nullptr });
+        c.removed = true;
+        eligibilityReady = false;
+        ++absent;
+        graphStale = true;
+        byCode.clear();
+        titleIndex.clear();
+        return true;
+    }
+
+    // new title and full prerequisite list; edges are diffed, not rebuilt
+    bool updateCourse(string_view code, string_view title, const vector<string_view>& prereqs, string& err) {
+        title = trimView(title);
+        if (title.empty()) { err = "title is required"; return false; }
+        beginEdit();
+        uint32_t id = 0;
+        if (!lookupId(code, id, err)) return false;
+        if (!replacePrereqs(id, internPrereqs(prereqs), err)) return false;
+        courses[id].setCourseTitle(editText.emplace_back(title));
+        titleIndex.clear();
+        return true;
+    }
+
+    bool addPrereq(string_view code, string_view prereq, string& err) {
+        beginEdit();
+        uint32_t id = 0;
+        if (!lookupId(code, id, err)) return false;
+        vector<uint32_t> list(courses[id].prerequisites().begin(), courses[id].prerequisites().end());
+        string key = upperCopy(trimView(prereq));
+        if (key.empty()) { err = "empty prerequisite"; return false; }
+        uint32_t p = codes.intern(key);
+        if (std::find(list.begin(), list.end(), p) != list.end()) { err = string(codeOf(id)) + " already requires " + string(codeOf(p)); return false; }
+        list.push_back(p);
+        return replacePrereqs(id, std::move(list), err);
+    }
+
+    bool removePrereq(string_view code, string_view prereq, string& err) {
+        beginEdit();
+        uint32_t id = 0;
+        if (!lookupId(code, id, err)) return false;
+        vector<uint32_t> list(courses[id].prerequisites().begin(), courses[id].prerequisites().end());
+        string key = upperCopy(trimView(prereq));
+        uint32_t p = codes.find(key);                   // a typo must not become a code
+        if (p == CodeTable::npos) { err = key + " not found"; return false; }
+        auto it = std::find(list.begin(), list.end(), p);
+        if (it == list.end()) { err = string(codeOf(id)) + " does not require " + string(codeOf(p)); return false; }
+        list.erase(it);
+        return replacePrereqs(id, std::move(list), err);
+    }
+
+    // rebuilds graph/rgraph (and resets the closure memo) if edits have left them behind
+    void syncGraph() {
+        if (!graphStale) return;
+        graph = dag.toCsr();
+        rgraph = graph.reversed();
+        closure.reset(&rgraph);
+        levelsReady = false;
+        graphStale = false;
+        if (!dag.isOrdered()) {                         // an edit may have broken the last cycle
+            bool ok = false;
+            vector<uint32_t> order = csrTopoOrder(graph, ok);
+            if (ok) dag.setOrder(std::move(order));
+        }
+    }
+
+private:
+    DynamicDag dag;                                     // editable graph; built on the first edit
+    deque<string> editText;                             // titles set by edits (stable addresses)
+    unordered_map<uint32_t, vector<uint32_t>> editPrereqs; // prerequisite lists changed by edits
+    size_t absent = 0;                                  // tombstones in courses
+    bool graphStale = false;                            // graph/rgraph lag behind dag
+
+    void beginEdit() {
+        if (edited) return;
+        if (hmap.size() != courses.size()) buildHash();
+        dag.init(graph, rgraph);
+        byCode.clear();                                 // trees are edited directly from now on
+        sindex.clear();
+        edited = true;
+    }
+
+    bool lookupId(string_view code, uint32_t& id, string& err) const {
+        auto it = hmap.find(trimView(code));
+        if (it == hmap.end()) { err = upperCopy(trimView(code)) + " not found"; return false; }
+        id = it->second;
+        return true;
+    }
+
+    vector<uint32_t> internPrereqs(const vector<string_view>& prereqs) {
+        vector<uint32_t> list;
+        for (string_view p : prereqs) {
+            string key = upperCopy(trimView(p));
+            if (key.empty()) continue;
+            uint32_t pid = codes.intern(key);
+            if (std::find(list.begin(), list.end(), pid) == list.end()) list.push_back(pid);
+        }
+        return list;
+    }
+
+    // Makes courses[id] exist, padding with tombstones (ids of codes that have no course
+    // row). Growing reallocates, so the trees are re-pointed before the old store goes.
+    void growStore(uint32_t id) {
+        if (id < courses.size()) return;
+        if (id >= courses.capacity()) {
+            vector<Course> bigger;
+            bigger.reserve(max<size_t>((size_t)id + 1, courses.capacity() * 2));
+            bigger.assign(courses.begin(), courses.end());
+            if constexpr (Indexes::bst) bst.rebase(courses.data(), bigger.data());
+            if constexpr (Indexes::avl) avl.rebase(courses.data(), bigger.data());
+            courses.swap(bigger);
+        }
+        while (courses.size() <= id) {
+            Course c;
+            c.id = (uint32_t)courses.size();
+            c.setCourseNumber(codes.name(c.id));
+            c.removed = true;
+            courses.push_back(c);
+            dag.addVertex();
+            ++absent;
+        }
+    }
+
+    void setPrereqs(uint32_t id, vector<uint32_t> list) {
+        eligibilityReady = false;
+        if (list.size() <= Course::PREREQ_INLINE) {
+            courses[id].setPrerequisites({ list.data(), list.data() + list.size() });
+            editPrereqs.erase(id);
+            return;
+        }
+        vector<uint32_t>& own = editPrereqs[id];
+        own = std::move(list);
+        courses[id].setPrerequisites({ own.data(), own.data() + own.size() });
+    }
+
+    // all or nothing: on a cycle every edge added so far is taken back out again
+    bool addEdges(const vector<pair<uint32_t, uint32_t>>& edges, string& err) {
+        for (size_t i = 0; i < edges.size(); ++i) {
+            if (dag.addEdge(edges[i].first, edges[i].second)) continue;
+            for (size_t j = 0; j < i; ++j) dag.removeEdge(edges[j].first, edges[j].second);
+            err = "would create a cycle: " + string(codeOf(edges[i].first)) + " already requires " + string(codeOf(edges[i].second));
+            if (edges[i].first == edges[i].second) err = "a course cannot require itself";
+            return false;
+        }
+        graphStale = graphStale || !edges.empty();
+        return true;
+    }
+
+    bool replacePrereqs(uint32_t id, vector<uint32_t> list, string& err) {
+        // diff as sorted multisets: a CSV row may list the same prereq twice (two edges)
+        auto edgeEnds = [&](const uint32_t* b, const uint32_t* e) {
+            vector<uint32_t> v;
+            for (; b != e; ++b) if (*b == id || isCourse(*b)) v.push_back(*b);
+            sort(v.begin(), v.end());
+            return v;
+            };
+        vector<uint32_t> before = edgeEnds(courses[id].prerequisites().begin(), courses[id].prerequisites().end());
+        vector<uint32_t> after = edgeEnds(list.data(), list.data() + list.size());
+        vector<uint32_t> gained, lost;
+        set_difference(after.begin(), after.end(), before.begin(), before.end(), back_inserter(gained));
+        set_difference(before.begin(), before.end(), after.begin(), after.end(), back_inserter(lost));
+        vector<pair<uint32_t, uint32_t>> added;
+        for (uint32_t p : gained) added.emplace_back(p, id);
+        if (!addEdges(added, err)) return false;
+        for (uint32_t p : lost) dag.removeEdge(p, id);
+        graphStale = true;
+
+        missingPrereqs.erase(remove_if(missingPrereqs.begin(), missingPrereqs.end(),
+            [&](const pair<uint32_t, uint32_t>& m) { return m.first == id; }), missingPrereqs.end());
+        setPrereqs(id, std::move(list));
+        for (uint32_t p : courses[id].prerequisites()) if (!isCourse(p)) missingPrereqs.emplace_back(id, p);
+        return true;
+    }
+};
+
+using CourseCatalog = BasicCourseCatalog<AllIndexes>;
+using ServingCatalog = BasicCourseCatalog<HashIndex>;  // lookups, prefixes and graph queries only
+
+// live catalog (hot reload)
+
+// Owns the published catalog. A reader takes a Snapshot (shared_ptr to a fully built
+// ServingCatalog that nobody modifies again) and uses it for as long as it holds it.
+// reload() builds the replacement off to the side and swaps the pointer atomically, so
+// readers never wait on a load or see a half-built catalog; the old one is freed by
+// whoever drops the last reference to it.
+class LiveCatalog {
+public:
+    using Snapshot = shared_ptr<const ServingCatalog>;
+
+    LiveCatalog(string file, unsigned threads) : sourceFile(std::move(file)), loadThreads(threads) {}
+    ~LiveCatalog() { stop(); }
+    LiveCatalog(const LiveCatalog&) = delete;
+    LiveCatalog& operator=(const LiveCatalog&) = delete;
+
+    Snapshot current() const { return atomic_load(&published); }
+    uint64_t version() const { return generation.load(); }
+
+    // Loads the source file into a new catalog and publishes it. On failure the current
+    // catalog stays published. Concurrent reloads are serialized; loadMs, when given,
+    // receives this reload's own build time.
+    bool reload(string& why, double* loadMs = nullptr) {
+        lock_guard<mutex> lk(reloadLock);
+        auto t0 = chrono::steady_clock::now();
+        auto next = make_shared<ServingCatalog>();
+        next->sourceFile = sourceFile;
+        next->loadThreads = loadThreads;
+        next->quiet = true;
+        if (!next->loadAll(sourceFile)) { why = "cannot open " + sourceFile; return false; }
+        if (next->courses.empty()) { why = sourceFile + " has no courses"; return false; }
+        next->titleIndex.build(next->courses);          // readers cannot build these lazily
+        next->codeOrder();
+        if (loadMs) *loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        atomic_store(&published, Snapshot(std::move(next)));
+        generation.fetch_add(1);
+        return true;
+    }
+
+    // Watches the source file and reloads after every completed write or rename onto it
+    // (inotify on Linux, a size/mtime poll elsewhere). Reports go to cout.
+    void watch() {
+        if (watcher.joinable()) return;
+        stopping = false;
+        watcher = thread([this] { watchLoop(); });
+    }
+
+    void stop() {
+        stopping = true;
+        if (watcher.joinable()) watcher.join();
+    }
+
+private:
+    string sourceFile;
+    unsigned loadThreads;
+    Snapshot published;                                 // only touched through atomic_load/atomic_store
+    atomic<uint64_t> generation{ 0 };
+    mutex reloadLock;
+    thread watcher;
+    atomic<bool> stopping{ false };
+
+    void reloadAndReport() {
+        string why;
+        double ms = 0;
+        if (reload(why, &ms)) {
+            Snapshot s = current();
+            cout << "\n[reload] " << sourceFile << ": version " << version() << ", " << s->courses.size()
+                << " courses in " << ms << " ms\n" << flush;
+        }
+        else cout << "\n[reload] kept version " << version() << " (" << why << ")\n" << flush;
+    }
+
+#if defined(__linux__)
+    void watchLoop() {
+        // watch the directory: editors often write a temp file and rename it over the original
+        filesystem::path p(sourceFile);
+        string dir = p.has_parent_path() ? p.parent_path().string() : ".";
+        string name = p.filename().string();
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            if (fd >= 0) close(fd);
+            cout << "[reload] cannot watch " << dir << "; hot reload is off\n";
+            return;
+        }
+        alignas(inotify_event) char buf[4096];
+        bool pending = false;
+        while (!stopping) {
+            pollfd pfd{ fd, POLLIN, 0 };
+            int ready = poll(&pfd, 1, pending ? 100 : 250);   // 100 ms of quiet ends a burst of writes
+            if (ready <= 0) {
+                if (pending && ready == 0) { pending = false; reloadAndReport(); }
+                continue;
+            }
+            ssize_t len;
+            while ((len = read(fd, buf, sizeof buf)) > 0) {
+                for (char* q = buf; q < buf + len;) {
+                    auto* ev = reinterpret_cast<inotify_event*>(q);
+                    if (ev->len && name == ev->name) pending = true;
+                    q += sizeof(inotify_event) + ev->len;
+                }
+            }
+        }
+        close(fd);
+    }
+#else
+    void watchLoop() {
+        uint64_t size = 0, lastSize = 0;
+        int64_t time = 0, lastTime = 0;
+        sourceStamp(sourceFile, lastSize, lastTime);
+        while (!stopping) {
+            this_thread::sleep_for(chrono::milliseconds(500));
+            if (!sourceStamp(sourceFile, size, time) || (size == lastSize && time == lastTime)) continue;
+            lastSize = size; lastTime = time;
+            reloadAndReport();
+        }
+    }
+#endif
+};
+
+// concurrent queries
+
+// Per-thread read handle on a LiveCatalog. Every query first compares the published
+// version with the one this reader holds (one atomic load: no lock, no shared write) and
+// re-acquires the snapshot only after a reload. Results point into the held snapshot and
+// stay valid until a later query on this reader picks up a newer version. Closure memos
+// and the topological order are cached per reader, so nothing is shared but the snapshot.
+// One CatalogReader per thread; a reader itself is not thread-safe.
+class CatalogReader {
+public:
+    explicit CatalogReader(const LiveCatalog& source) : live(source) {}
+
+    const ServingCatalog& catalog() { refresh(); return *snap; }
+
+    const Course* find(string_view code) { return catalog().findHash(code); }
+    string_view codeOf(uint32_t id) { return catalog().codeOf(id); }
+
+    // direct prerequisites (ids; missing codes included, resolve with codeOf)
+    IdRange prerequisites(const Course& c) const { return c.prerequisites(); }
+
+    const vector<uint32_t>& topoOrder(bool& ok) {
+        refresh();
+        if (!orderReady) { order = csrTopoOrder(snap->graph, orderOk); orderReady = true; }
+        ok = orderOk;
+        return order;
+    }
+
+    PrereqClosure::Chain allPrereqs(uint32_t id) { refresh(); return closure.chain(id); }
+
+    IdRange findPrefix(string_view prefix) { return catalog().prefixRange(trimView(prefix)); }
+    vector<uint32_t> searchTitles(string_view query) { return catalog().titleIndex.search(query); }
+
+    uint64_t version() const { return seen; }
+
+private:
+    const LiveCatalog& live;
+    LiveCatalog::Snapshot snap;
+    uint64_t seen = 0;
+    PrereqClosure closure;
+    vector<uint32_t> order;
+    bool orderReady = false, orderOk = false;
+
+    void refresh() {
+        uint64_t v = live.version();
+        if (v == seen && snap) return;
+        snap = live.current();
+        seen = v;
+        closure.reset(&snap->rgraph);
+        orderReady = false;
+    }
+};
+
+// Lookups per second at 1, 2, 4 ... threads for three ways of sharing the catalog: one
+// mutex around a shared catalog, atomic_load of the shared_ptr on every query, and a
+// CatalogReader per thread. The mixed run adds prerequisite listings and closure queries.
+static void benchmarkQueries(const string& file, unsigned loadThreads, size_t opsPerThread = 2000000) {
+    LiveCatalog live(file, loadThreads);
+    string why;
+    if (!live.reload(why)) { cout << "Error: " << why << "\n\n"; return; }
+    LiveCatalog::Snapshot base = live.current();
+    vector<string> keys;
+    keys.reserve(base->courses.size());
+    for (const auto& c : base->courses) keys.emplace_back(c.courseNumber());
+    mutex shared;
+
+    unsigned hw = max(1u, thread::hardware_concurrency());
+    vector<unsigned> counts{ 1 };
+    while (counts.back() < max(4u, hw)) counts.push_back(counts.back() * 2);
+
+    cout << "Concurrent queries: " << keys.size() << " courses, " << opsPerThread << " ops per thread, "
+        << hw << " hardware thread" << (hw == 1 ? "" : "s") << "\n\n";
+    cout << left << setw(22) << "mode" << right << setw(9) << "threads" << setw(14) << "Mops/s" << setw(10) << "scaling" << '\n';
+    auto run = [&](const char* name, auto work) {
+        double single = 0;
+        for (unsigned t : counts) {
+            atomic<size_t> sink{ 0 };                   // results are summed so the work is kept
+            vector<thread> workers;
+            auto t0 = chrono::steady_clock::now();
+            for (unsigned w = 0; w < t; ++w) {
+                workers.emplace_back([&, w] {
+                    mt19937_64 rng(499 + w);
+                    sink += work(rng);
+                    });
+            }
+            for (auto& th : workers) th.join();
+            double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            double mops = (double)opsPerThread * t / secs / 1e6;
+            if (t == 1) single = mops;
+            cout << left << setw(22) << name << right << setw(9) << t << setw(14) << fixed << setprecision(2) << mops
+                << setw(9) << mops / single << "x" << defaultfloat << setprecision(6) << '\n';
+        }
+        };
+
+    run("global mutex", [&](mt19937_64& rng) {
+        size_t hits = 0;
+        for (size_t i = 0; i < opsPerThread; ++i) {
+            lock_guard<mutex> lk(shared);
+            hits += base->findHash(keys[rng() % keys.size()]) != nullptr;
+        }
+        return hits;
+        });
+    run("atomic_load per query", [&](mt19937_64& rng) {
+        size_t hits = 0;
+        for (size_t i = 0; i < opsPerThread; ++i) hits += live.current()->findHash(keys[rng() % keys.size()]) != nullptr;
+        return hits;
+        });
+    run("reader per thread", [&](mt19937_64& rng) {
+        CatalogReader reader(live);
+        size_t hits = 0;
+        for (size_t i = 0; i < opsPerThread; ++i) hits += reader.find(keys[rng() % keys.size()]) != nullptr;
+        return hits;
+        });
+    run("reader, mixed", [&](mt19937_64& rng) {
+        // 90% lookups, 9% direct prerequisite listings, 1% full closure queries
+        CatalogReader reader(live);
+        size_t work = 0;
+        for (size_t i = 0; i < opsPerThread; ++i) {
+            const Course* c = reader.find(keys[rng() % keys.size()]);
+            unsigned roll = (unsigned)(rng() % 100);
+            if (!c || roll < 90) { work += c != nullptr; continue; }
+            if (roll < 99) { for (uint32_t p : reader.prerequisites(*c)) work += reader.codeOf(p).size(); }
+            else work += reader.allPrereqs(c->id).ids.size();
+        }
+        return work;
+        });
+    cout << '\n';
+}
+
+// graph benchmark: the original string-keyed versions vs the CSR versions
+
+using StringGraph = unordered_map<string, vector<string>>;
+
+static bool mapHasCycle(const StringGraph& graph) {
+    enum State { UNVIS = 0, VISITING = 1, VISITED = 2 };
+    unordered_map<string, int> state;
+    for (auto& kv : graph) state[kv.first] = UNVIS;
+
+    function<bool(const string&)> dfs = [&](const string& u)->bool {
+        state[u] = VISITING;
+        auto it = graph.find(u);
+        if (it != graph.end()) {
+            for (const auto& v : it->second) {
+                if (state[v] == VISITING) return true;        // back-edge
+                if (state[v] == UNVIS && dfs(v)) return true; // deeper cycle
+            }
+        }
+        state[u] = VISITED;
+        return false;
+        };
+
+    for (auto& kv : graph) {
+        if (state[kv.first] == UNVIS && dfs(kv.first)) return true;
+    }
+    return false;
+}
+
+static vector<string> mapTopoOrder(const StringGraph& graph, bool& ok) {
+    unordered_map<string, int> indeg;
+    for (auto& kv : graph) {
+        if (!indeg.count(kv.first)) indeg[kv.first] = 0;
+        for (auto& v : kv.second) indeg[v]++;
+    }
+    queue<string> q;
+    for (auto& kv : indeg) if (kv.second == 0) q.push(kv.first);
+
+    vector<string> order;
+    while (!q.empty()) {
+        string u = q.front(); q.pop();
+        order.push_back(u);
+        auto it = graph.find(u);
+        if (it != graph.end()) {
+            for (auto& v : it->second) {
+                if (--indeg[v] == 0) q.push(v);
+            }
+        }
+    }
+    ok = (order.size() == indeg.size());
+    return order;
+}
+
+// Layered random DAG: every edge goes from a node to one in a later layer (so DFS depth
+// stays <= layers), any later layer if span is 0, else one of the next span layers.
+static vector<pair<uint32_t, uint32_t>> layeredEdges(uint32_t nodes, size_t edges, uint32_t layers, uint32_t span, uint64_t seed) {
+    mt19937_64 rng(seed);
+    uint32_t perLayer = max(1u, nodes / layers);
+    vector<pair<uint32_t, uint32_t>> edgeList;
+    edgeList.reserve(edges);
+    while (edgeList.size() < edges) {
+        uint32_t u = (uint32_t)(rng() % (nodes - perLayer));
+        uint32_t lo = (u / perLayer + 1) * perLayer;
+        uint32_t hi = span ? (uint32_t)min<uint64_t>(nodes, lo + (uint64_t)span * perLayer) : nodes;
+        uint32_t v = lo + (uint32_t)(rng() % (hi - lo));
+        edgeList.emplace_back(u, v);
+    }
+    return edgeList;
+}
+
+static void benchmarkGraph(uint32_t nodes = 200000, size_t edges = 1000000, uint32_t layers = 50, size_t reps = 3) {
+    using clock = chrono::steady_clock;
+    vector<pair<uint32_t, uint32_t>> edgeList = layeredEdges(nodes, edges, layers, 0, 499);
+
+    StringGraph sg;
+    auto name = [](uint32_t id) { return "C" + to_string(id); };
+    for (uint32_t u = 0; u < nodes; ++u) sg[name(u)];
+    for (const auto& e : edgeList) sg[name(e.first)].push_back(name(e.second));
+    CsrGraph g = CsrGraph::build(nodes, edgeList);
+
+    auto bench = [&](const string& label, auto fn) {
+        double best = 1e300;
+        size_t check = 0;
+        for (size_t r = 0; r < reps; ++r) {
+            auto t0 = clock::now();
+            check = fn();
+            auto t1 = clock::now();
+            best = min(best, chrono::duration<double, milli>(t1 - t0).count());
+        }
+        cout << label << " best: " << best << " ms  (check: " << check << ")\n";
+        };
+
+    cout << "Benchmarking graph algorithms (" << nodes << " nodes, " << edges << " edges, best of " << reps << ")...\n";
+    bench("hasCycle  map<string>", [&] { return (size_t)mapHasCycle(sg); });
+    bench("hasCycle  CSR", [&] { return (size_t)csrHasCycle(g); });
+    bench("SCC       CSR (Tarjan)", [&] { return csrCyclicComponents(g).size(); });
+    bench("topoOrder map<string>", [&] { bool ok; return mapTopoOrder(sg, ok).size(); });
+    bench("topoOrder CSR", [&] { bool ok; return csrTopoOrder(g, ok).size(); });
+    cout << '\n';
+}
+
+// synthetic catalog generator
+
+struct GenConfig {
+    size_t courses = 100000;
+    uint32_t maxPrereqs = 3;           // fan-in: each course gets 0..maxPrereqs prerequisites
+    uint32_t layers = 12;              // DAG depth; prerequisites always come from earlier layers
+    string order = "random";           // row order in the file: sorted, reverse or random
+    size_t cycles = 0;                 // back edges that each close a cycle of length 2..4
+    size_t missing = 0;                // prerequisite references to codes with no course row
+    size_t malformed = 0;              // rows the loader has to reject
+    uint64_t seed = 1;
+};
+
+// Course code for index i: four letters and four digits ("ABCD0042"), unique, at most
+// eight chars, and ordered the same way as i.
+static string syntheticCode(size_t i) {
+    string code = "AAAA0000";
+    size_t dept = i / 10000, num = i % 10000;
+    for (int k = 3; k >= 0; --k) { code[k] = char('A' + dept % 26); dept /= 26; }
+    for (int k = 7; k >= 4; --k) { code[k] = char('0' + num % 10); num /= 10; }
+    return code;
+}
+
+// Writes a catalog in the input CSV format. Only raw mt19937_64 output is used (no
+// std distributions or std::shuffle), so a seed gives the same file on every platform.
+static bool generateCatalog(const GenConfig& cfg, ostream& out) {
+    static const char* const kWords[] = {
+        "Introduction", "Advanced", "Applied", "Theory", "Systems", "Programming", "Data",
+        "Structures", "Algorithms", "Networks", "Security", "Databases", "Mathematics",
+        "Statistics", "Design", "Analysis", "Computing", "Software", "Engineering", "Methods",
+        "Graphics", "Machine", "Learning", "Operating", "Discrete", "Logic", "Compilers", "Topics",
+    };
+    const size_t wordCount = sizeof(kWords) / sizeof(kWords[0]);
+    const size_t n = cfg.courses;
+    const uint32_t layers = max<uint32_t>(1, cfg.layers);
+    if (n == 0) return false;
+    mt19937_64 rng(cfg.seed);
+    auto pick = [&](size_t m) { return m ? (size_t)(rng() % m) : 0; };
+
+    // DAG position p -> code index, so code order says nothing about depth
+    vector<uint32_t> codeOf(n);
+    for (size_t i = 0; i < n; ++i) codeOf[i] = (uint32_t)i;
+    for (size_t i = n - 1; i > 0; --i) swap(codeOf[i], codeOf[pick(i + 1)]);
+
+    // positions [layerStart[l], layerStart[l + 1]) form layer l
+    vector<size_t> layerStart(layers + 1);
+    for (uint32_t l = 0; l <= layers; ++l) layerStart[l] = n * l / layers;
+
+    // first prerequisite comes from the previous layer (so the depth is real), the rest
+    // from any earlier layer
+    vector<vector<uint32_t>> prereqs(n);
+    for (uint32_t l = 1; l < layers; ++l) {
+        size_t prevBegin = layerStart[l - 1], prevSize = layerStart[l] - prevBegin;
+        for (size_t p = layerStart[l]; p < layerStart[l + 1]; ++p) {
+            if (prevSize == 0) continue;
+            size_t k = pick(cfg.maxPrereqs + 1);
+            for (size_t j = 0; j < k; ++j) {
+                uint32_t q = (uint32_t)(j == 0 ? prevBegin + pick(prevSize) : pick(layerStart[l]));
+                if (find(prereqs[p].begin(), prereqs[p].end(), q) == prereqs[p].end()) prereqs[p].push_back(q);
+            }
+        }
+    }
+
+    // each cycle: follow first prerequisites down from a course, then make the last one
+    // require the course it started from
+    size_t cyclesMade = 0;
+    for (size_t tries = 0; cyclesMade < cfg.cycles && tries < cfg.cycles * 20 + 100; ++tries) {
+        uint32_t start = (uint32_t)pick(n);
+        uint32_t at = start;
+        size_t steps = 1 + pick(3);
+        for (size_t s = 0; s < steps && !prereqs[at].empty(); ++s) at = prereqs[at][0];
+        if (at == start) continue;
+        prereqs[at].push_back(start);
+        ++cyclesMade;
+    }
+
+    vector<uint32_t> rows(n);
+    for (size_t i = 0; i < n; ++i) rows[i] = (uint32_t)i;
+    sort(rows.begin(), rows.end(), [&](uint32_t a, uint32_t b) { return codeOf[a] < codeOf[b]; });
+    if (cfg.order == "reverse") reverse(rows.begin(), rows.end());
+    else if (cfg.order == "random") for (size_t i = n - 1; i > 0; --i) swap(rows[i], rows[pick(i + 1)]);
+    else if (cfg.order != "sorted") return false;
+
+    // which rows get a missing prerequisite appended / are followed by a malformed row
+    vector<uint32_t> missingAt(cfg.missing), malformedAt(cfg.malformed);
+    for (auto& r : missingAt) r = (uint32_t)pick(n);
+    for (auto& r : malformedAt) r = (uint32_t)pick(n);
+    sort(missingAt.begin(), missingAt.end());
+    sort(malformedAt.begin(), malformedAt.end());
+
+    string buf;
+    buf.reserve(1 << 20);
+    size_t mi = 0, bi = 0;
+    for (size_t r = 0; r < n; ++r) {
+        uint32_t p = rows[r];
+        buf += syntheticCode(codeOf[p]);
+        buf += ',';
+        size_t words = 2 + pick(3);
+        for (size_t w = 0; w < words; ++w) {
+            if (w) buf += ' ';
+            buf += kWords[pick(wordCount)];
+        }
+        buf += ' ';
+        buf += to_string(100 + codeOf[p] % 400);
+        for (uint32_t q : prereqs[p]) { buf += ','; buf += syntheticCode(codeOf[q]); }
+        for (; mi < missingAt.size() && missingAt[mi] == r; ++mi) buf += ",MISSING" + to_string(mi);
+        buf += '\n';
+        for (; bi < malformedAt.size() && malformedAt[bi] == r; ++bi)
+            buf += (bi % 2) ? syntheticCode(codeOf[p]) + "X\n" : string(",Untitled Row\n");
+        if (buf.size() > (1 << 20) - 512) { out.write(buf.data(), (streamsize)buf.size()); buf.clear(); }
+    }
+    out.write(buf.data(), (streamsize)buf.size());
+    return (bool)out;
+}
+
+// benchmark suite
+
+struct BenchConfig {
+    size_t ops = 100000;               // timed lookups per workload and structure
+    size_t reps = 5;                   // repetitions for load and graph timings
+    uint64_t seed = 499;
+};
+
+// keeps a value alive so the compiler cannot drop the work that produced it
+template <class T>
+static inline void doNotOptimize(const T& v) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(v) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &v;
+#endif
+}
+
+// swallows cout while loadAll is being timed
+struct QuietCout {
+    struct NullBuf : streambuf { int overflow(int c) override { return c; } } nullBuf;
+    streambuf* saved;
+    QuietCout() : saved(cout.rdbuf(&nullBuf)) {}
+    ~QuietCout() { cout.rdbuf(saved); }
+};
 
-struct AVLNode {
-    Course course;
-    AVLNode* left;
-    AVLNode* right;
-    int height;
-    explicit AVLNode(const Course& c) : course(c), left(nullptr), right(nullptr), height(1) {}
+struct LatencyStats {
+    double p50 = 0, p99 = 0, p999 = 0, max = 0, mean = 0;
+    double batchNs = 0;                // ns/op of an untimed-per-op pass (no clock overhead)
+    double allocs = 0;                 // heap allocations per op in that pass
+    size_t hits = 0;
+    uint64_t check = 0;                // folds the results so they have to be computed
 };
 
-class AVLTree {
-    AVLNode* root = nullptr;
+struct TimingStats { double best = 0, median = 0; };
 
-    static int h(AVLNode* n) { return n ? n->height : 0; }
-    static int bf(AVLNode* n) { return n ? h(n->left) - h(n->right) : 0; }
+static double percentile(const vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    return sorted[min(sorted.size() - 1, (size_t)(q * (double)sorted.size()))];
+}
 
-    static void update(AVLNode* n) {
-        if (n) n->height = 1 + max(h(n->left), h(n->right));
+template <class F>
+static TimingStats timeRuns(size_t reps, F fn) {
+    using clock = chrono::steady_clock;
+    vector<double> ms;
+    for (size_t r = 0; r < max<size_t>(1, reps); ++r) {
+        auto t0 = clock::now();
+        fn();
+        auto t1 = clock::now();
+        ms.push_back(chrono::duration<double, milli>(t1 - t0).count());
     }
+    sort(ms.begin(), ms.end());
+    return { ms.front(), ms[ms.size() / 2] };
+}
 
-    static AVLNode* rotateRight(AVLNode* y) {
-        AVLNode* x = y->left;
-        AVLNode* T2 = x->right;
-        x->right = y; y->left = T2;
-        update(y); update(x);
-        return x;
-    }
+// Downstream impact on two layered DAGs of the same size: a wide one, where a first-layer
+// course reaches most of the graph in a few levels (bottom-up pays off), and a deep one,
+// where the frontier stays small for a couple of hundred levels (top-down all the way).
+// The sources are timed one query per pass, then all together in LANES-wide passes, in
+// each direction mode.
+static void benchmarkImpact(uint32_t nodes = 200000, size_t edges = 1000000, size_t queries = 64) {
+    using clock = chrono::steady_clock;
+    struct Shape { const char* name; uint32_t layers, span; };
+    const Shape shapes[] = { { "wide", 8, 1 }, { "deep", 200, 1 } };
+    const pair<const char*, BfsMode> modes[] = {
+        { "top-down", BfsMode::TopDown }, { "bottom-up", BfsMode::BottomUp }, { "auto", BfsMode::Auto } };
 
-    static AVLNode* rotateLeft(AVLNode* x) {
-        AVLNode* y = x->right;
-        AVLNode* T2 = y->left;
-        y->left = x; x->right = T2;
-        update(x); update(y);
-        return y;
-    }
+    cout << "Benchmarking downstream impact (" << nodes << " nodes, " << edges << " edges, "
+        << queries << " sources from the first layer)...\n" << fixed << setprecision(1);
+    for (const Shape& shape : shapes) {
+        CsrGraph g = CsrGraph::build(nodes, layeredEdges(nodes, edges, shape.layers, shape.span, 499));
+        CsrGraph rg = g.reversed();
+        mt19937_64 rng(7);
+        uint32_t perLayer = max(1u, nodes / shape.layers);
+        vector<vector<uint32_t>> sources(queries);
+        for (auto& s : sources) s.push_back((uint32_t)(rng() % perLayer));
 
-    static AVLNode* balance(AVLNode* node) {
-        update(node);
-        int b = bf(node);
-        if (b > 1) {
-            if (bf(node->left) < 0) node->left = rotateLeft(node->left);
-            return rotateRight(node);
+        ImpactSearch search;
+        size_t reached = 0;
+        auto count = [&](size_t, IdRange r) { reached += r.size(); };
+        search.run(g, rg, sources, count);             // warm up (sizes the scratch)
+        cout << shape.name << " (" << shape.layers << " layers):\n";
+        for (const auto& m : modes) {
+            vector<double> us;
+            size_t levels = 0, bottomUp = 0;
+            reached = 0;
+            for (size_t i = 0; i < queries; ++i) {
+                vector<vector<uint32_t>> one(1, sources[i]);
+                auto t0 = clock::now();
+                search.run(g, rg, one, count, m.second);
+                us.push_back(chrono::duration<double, micro>(clock::now() - t0).count());
+                levels += search.levels;
+                bottomUp += search.bottomUpLevels;
+            }
+            sort(us.begin(), us.end());
+            cout << "  single " << left << setw(10) << m.first << right << " p50 " << setw(9) << percentile(us, 0.50)
+                << " us  p99 " << setw(9) << percentile(us, 0.99) << " us  " << levels / queries << " levels ("
+                << bottomUp * 100 / max<size_t>(1, levels) << "% bottom-up), " << reached / queries << " courses\n";
         }
-        if (b < -1) {
-            if (bf(node->right) > 0) node->right = rotateRight(node->right);
-            return rotateLeft(node);
+        for (const auto& m : modes) {
+            TimingStats t = timeRuns(3, [&] { search.run(g, rg, sources, count, m.second); });
+            cout << "  batched " << left << setw(9) << m.first << right << " " << setw(9) << t.best * 1000 / queries
+                << " us/query  " << search.levels << " levels, " << search.bottomUpLevels << " bottom-up\n";
         }
-        return node;
     }
+    cout << defaultfloat << setprecision(6) << '\n';
+}
 
-    static AVLNode* insertRec(AVLNode* node, const Course& c) {
-        if (!node) return new AVLNode(c);
-        if (c.courseNumber < node->course.courseNumber) node->left = insertRec(node->left, c);
-        else node->right = insertRec(node->right, c);
-        return balance(node);
-    }
+// Warms up, then times every lookup on its own for the percentiles and the whole query
+// list once more in one block for throughput, counting the allocations it makes.
+template <class Find>
+static LatencyStats measureLookups(const vector<const string*>& queries, Find find) {
+    using clock = chrono::steady_clock;
+    LatencyStats st;
+    uint64_t check = 0;
+    for (size_t i = 0; i < queries.size() / 10; ++i) check += (uintptr_t)find(*queries[i]);
 
-    static const Course* searchRec(AVLNode* node, const string& key) {
-        if (!node) return nullptr;
-        if (node->course.courseNumber == key) return &node->course;
-        if (key < node->course.courseNumber) return searchRec(node->left, key);
-        return searchRec(node->right, key);
+    vector<double> ns(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        auto t0 = clock::now();
+        const Course* c = find(*queries[i]);
+        doNotOptimize(c);
+        auto t1 = clock::now();
+        ns[i] = chrono::duration<double, nano>(t1 - t0).count();
+        st.hits += (c != nullptr);
+        check += (uintptr_t)c;
     }
 
-    static void destroy(AVLNode* n) {
-        if (!n) return;
-        destroy(n->left); destroy(n->right); delete n;
-    }
+    allocRecorders.fetch_add(1, memory_order_relaxed);
+    const AllocCount a0 = threadAllocs;
+    auto t0 = clock::now();
+    for (const string* q : queries) check += (uintptr_t)find(*q);
+    doNotOptimize(check);
+    auto t1 = clock::now();
+    const AllocCount a1 = threadAllocs;
+    allocRecorders.fetch_sub(1, memory_order_relaxed);
+    st.batchNs = chrono::duration<double, nano>(t1 - t0).count() / max<size_t>(1, queries.size());
+    st.allocs = (double)(a1.count - a0.count) / max<size_t>(1, queries.size());
 
-public:
-    ~AVLTree() { destroy(root); }
-    void insert(const Course& c) { root = insertRec(root, c); }
-    const Course* search(const string& key) const { return searchRec(root, key); }
-};
+    double sum = 0;
+    for (double v : ns) sum += v;
+    sort(ns.begin(), ns.end());
+    st.mean = sum / max<size_t>(1, ns.size());
+    st.p50 = percentile(ns, 0.50);
+    st.p99 = percentile(ns, 0.99);
+    st.p999 = percentile(ns, 0.999);
+    st.max = ns.empty() ? 0 : ns.back();
+    st.check = check;
+    return st;
+}
 
-// course catalog structure
+static void appendJsonEscaped(string& out, string_view s) {
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out.push_back('\\'); out.push_back(c); }
+        else if ((unsigned char)c < 0x20) out += ' ';
+        else out.push_back(c);
+    }
+}
 
-class CourseCatalog {
-public:
-    // baselines with alternatives
-    vector<Course> vec;                                 // linear-scan baseline
-    BinarySearchTree bst;                               // original structure
-    AVLTree avl;                                        // balanced tree
-    unordered_map<string, Course> hmap;                 // hash index
+static string jsonEscape(string_view s) {
+    string out;
+    appendJsonEscaped(out, s);
+    return out;
+}
 
-    // Graph: prereq -> list of dependent courses
-    unordered_map<string, vector<string>> graph;
-    unordered_set<string> courseCodes;                  // set of all codes
+// loadAll of a catalog that builds only the indexes named by Indexes
+template <class Indexes>
+static TimingStats timePolicyLoad(const CourseCatalog& like, size_t reps) {
+    BasicCourseCatalog<Indexes> cat;
+    cat.loadThreads = like.loadThreads;
+    QuietCout quiet;
+    return timeRuns(reps, [&] { cat.loadAll(like.sourceFile); });
+}
 
-    // diagnostics
-    vector<string> malformedRows;
-    vector<pair<string, string>> missingPrereqs;         // course, missingPrereq
+// Times loadAll (with every index, then with each one alone), hasCycle, topoOrder,
+// cyclicGroups, courseLevels and eligibility, then every lookup
+// structure under five key orders: insertion order, uniform random, Zipfian (s = 0.99),
+// 90% misses and uniform in lower case. Writes a JSON report to `json` when given, else
+// a text table to cout. Everything runs on a fresh catalog loaded from like.sourceFile,
+// so edits and a mapped snapshot in `like` survive the run.
+static bool runBenchmarkSuite(const CourseCatalog& like, const BenchConfig& cfg, ostream* json) {
+    using clock = chrono::steady_clock;
+    CourseCatalog cat;
+    cat.sourceFile = like.sourceFile;
+    cat.loadThreads = like.loadThreads;
+    TimingStats load;
+    {
+        QuietCout quiet;
+        load = timeRuns(cfg.reps, [&] { cat.loadAll(cat.sourceFile); });
+    }
+    if (!cat.loaded) { cout << "Error opening file: " << cat.sourceFile << '\n'; return false; }
+    if (cat.courses.empty()) { cout << "No data.\n\n"; return false; }
+    if (cat.hmap.size() != cat.courses.size()) cat.buildHash();
+    const pair<const char*, TimingStats> policyLoads[] = {
+        { "loadAll_hash", timePolicyLoad<HashIndex>(cat, cfg.reps) },
+        { "loadAll_eytzinger", timePolicyLoad<StaticIndex>(cat, cfg.reps) },
+        { "loadAll_avl", timePolicyLoad<AvlIndex>(cat, cfg.reps) },
+        { "loadAll_bst", timePolicyLoad<BstIndex>(cat, cfg.reps) },
+    };
 
-    bool loaded = false;
+    size_t sink = 0;
+    TimingStats cyc = timeRuns(cfg.reps, [&] { sink += cat.hasCycle(); });
+    TimingStats topo = timeRuns(cfg.reps, [&] { bool ok; sink += cat.topoOrder(ok).size(); });
+    TimingStats scc = timeRuns(cfg.reps, [&] { sink += cat.cyclicGroups().size(); });
+    TimingStats lvl = timeRuns(cfg.reps, [&] {
+        sink += csrLevels(cat.graph, [&](uint32_t v) { return cat.isCourse(v); }, cat.loadPool()).levels();
+        });
 
-    void clear() {
-        vec.clear();
-        hmap.clear();
-        graph.clear();
-        courseCodes.clear();
-        malformedRows.clear();
-        missingPrereqs.clear();
-        loaded = false;
-        // bst & avl destructors clear on scope end so now we rely on fresh instances:
-        bst = BinarySearchTree();
-        avl = AVLTree();
+    // eligibility of 1024 transcripts (a random course and everything below it), bit-sliced
+    // and then one student at a time over the prerequisite lists
+    vector<vector<uint32_t>> transcripts(1024);
+    {
+        mt19937_64 pick(cfg.seed);
+        for (auto& t : transcripts) {
+            uint32_t id = (uint32_t)(pick() % cat.courses.size());
+            t = cat.allPrereqs(id).ids;
+            t.push_back(id);
+        }
     }
-
-    // Load CSV, build all structures, and validate
-    bool loadAll(const string& filename = "CS 300 ABCU_Advising_Program_Input.csv") {
-        clear();
-        ifstream file(filename);
-        if (!file.is_open()) {
-            cout << "Error opening file: " << filename << '\n';
-            return false;
+    cat.eligibility().eligible({});                     // build and size the scratch outside the timing
+    TimingStats elig = timeRuns(cfg.reps, [&] {
+        cat.eligibility().run(transcripts, [&](size_t, const EligibilityEngine::Courses& c) { sink += c.size(); });
+        });
+    TimingStats eligScalar = timeRuns(cfg.reps, [&] {
+        vector<char> done(cat.codes.size());
+        for (const auto& t : transcripts) {
+            for (uint32_t id : t) done[id] = 1;
+            for (const Course& c : cat.courses) {
+                if (c.removed || done[c.id]) continue;
+                bool ok = true;
+                for (uint32_t p : c.prerequisites()) if (!done[p]) { ok = false; break; }
+                sink += ok;
+            }
+            for (uint32_t id : t) done[id] = 0;
         }
+        });
+    doNotOptimize(sink);
 
-        string line;
-        size_t lineNo = 0;
-        vector<Course> staged;
+    // query pools: every course code, plus codes that are guaranteed misses
+    const size_t n = cat.courses.size();
+    vector<string> hits, misses;
+    hits.reserve(n);
+    for (const auto& c : cat.courses) hits.emplace_back(c.courseNumber());
+    mt19937_64 rng(cfg.seed);
+    while (misses.size() < min<size_t>(n, 65536)) {
+        string m = hits[rng() % n] + char('0' + rng() % 10);
+        if (!cat.findHash(m)) misses.push_back(std::move(m));
+    }
 
-        while (getline(file, line)) {
-            ++lineNo;
-            if (trim(line).empty()) continue;
-            stringstream ss(line);
-            string num, title, prereq;
-            vector<string> prereqs;
+    // Zipf ranks map onto a shuffled key order so the hot keys are spread out
+    vector<double> cdf(n);
+    double total = 0;
+    for (size_t i = 0; i < n; ++i) cdf[i] = (total += 1.0 / pow((double)(i + 1), 0.99));
+    vector<size_t> rankToKey(n);
+    for (size_t i = 0; i < n; ++i) rankToKey[i] = i;
+    shuffle(rankToKey.begin(), rankToKey.end(), rng);
+    uniform_real_distribution<double> unit(0.0, total);
 
-            if (!getline(ss, num, ',')) { malformedRows.push_back("Line " + to_string(lineNo) + ": missing course number"); continue; }
-            if (!getline(ss, title, ',')) { malformedRows.push_back("Line " + to_string(lineNo) + ": missing course title"); continue; }
+    // the same codes in lower case: hits only if the lookups fold case themselves
+    vector<string> lower(hits);
+    for (string& s : lower) for (char& ch : s) ch = (char)std::tolower((unsigned char)ch);
 
-            num = toUpper(trim(num));
-            title = trim(title);
-            if (num.empty() || title.empty()) {
-                malformedRows.push_back("Line " + to_string(lineNo) + ": empty course number/title");
-                continue;
-            }
+    const size_t ops = cfg.ops;
+    vector<pair<string, vector<const string*>>> workloads(5);
+    workloads[0].first = "sequential";
+    workloads[1].first = "uniform";
+    workloads[2].first = "zipf";
+    workloads[3].first = "miss90";
+    workloads[4].first = "lowercase";
+    for (size_t i = 0; i < ops; ++i) {
+        workloads[0].second.push_back(&hits[i % n]);
+        workloads[1].second.push_back(&hits[rng() % n]);
+        size_t r = (size_t)(lower_bound(cdf.begin(), cdf.end(), unit(rng)) - cdf.begin());
+        workloads[2].second.push_back(&hits[rankToKey[min(r, n - 1)]]);
+        workloads[3].second.push_back(rng() % 10 == 0 ? &hits[rng() % n] : &misses[rng() % misses.size()]);
+        workloads[4].second.push_back(&lower[rng() % n]);
+    }
 
-            while (getline(ss, prereq, ',')) {
-                prereq = toUpper(trim(prereq));
-                if (!prereq.empty()) prereqs.push_back(prereq);
-            }
+    // each contender is passed by its own lambda type, so measureLookups is instantiated
+    // for it and the lookup inlines into the timing loop
+    auto forEachContender = [&](auto&& run) {
+        run("vector", [&](string_view k) { return cat.findVector(k); });
+        run("bst", [&](string_view k) { return cat.findBST(k); });
+        run("avl", [&](string_view k) { return cat.findAVL(k); });
+        run("hash", [&](string_view k) { return cat.findHash(k); });
+        run("eytzinger", [&](string_view k) { return cat.findStatic(k); });
+        };
+    const size_t linearLimit = 100000;                  // a linear scan per op is hopeless past this
 
-            Course c(num, title, prereqs);
-            staged.push_back(c);
-            courseCodes.insert(num);
-        }
-        file.close();
+    // clock overhead, so per-op numbers can be read against it
+    vector<double> empty(10001);
+    for (auto& v : empty) {
+        auto t0 = clock::now();
+        auto t1 = clock::now();
+        v = chrono::duration<double, nano>(t1 - t0).count();
+    }
+    sort(empty.begin(), empty.end());
+    double timerNs = percentile(empty, 0.5);
 
-        // build structures
-        for (const auto& c : staged) {
-            vec.push_back(c);
-            hmap[c.courseNumber] = c;
-            bst.insert(c);
-            avl.insert(c);
-        }
+    struct Row { string workload, structure; LatencyStats st; bool skipped; };
+    vector<Row> rows;
+    for (const auto& w : workloads) {
+        forEachContender([&](const char* name, auto find) {
+            if (name == string_view("vector") && n > linearLimit) { rows.push_back({ w.first, name, {}, true }); return; }
+            rows.push_back({ w.first, name, measureLookups(w.second, find), false });
+            });
+    }
 
-        // build graph (prereq -> course) and record missing prereqs
-        for (const auto& c : staged) {
-            for (const auto& p : c.prerequisites) {
-                if (!courseCodes.count(p)) {
-                    missingPrereqs.emplace_back(c.courseNumber, p);
-                }
-                else {
-                    graph[p].push_back(c.courseNumber);
-                }
+    if (json) {
+        ostream& o = *json;
+        o << fixed << setprecision(1);
+        o << "{\n  \"source\": \"" << jsonEscape(cat.sourceFile) << "\",\n";
+        o << "  \"courses\": " << n << ",\n  \"edges\": " << cat.graph.edges() << ",\n";
+        o << "  \"ops\": " << ops << ",\n  \"reps\": " << cfg.reps << ",\n  \"seed\": " << cfg.seed << ",\n";
+#if defined(__VERSION__)
+        o << "  \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+#endif
+        o << "  \"timer_overhead_ns\": " << timerNs << ",\n";
+        auto timing = [&](const char* name, const TimingStats& t, bool last) {
+            o << "    \"" << name << "\": { \"best_ms\": " << setprecision(3) << t.best << ", \"median_ms\": " << t.median
+                << " }" << (last ? "\n" : ",\n") << setprecision(1);
+            };
+        o << "  \"phases\": {\n";
+        timing("loadAll", load, false);
+        for (const auto& p : policyLoads) timing(p.first, p.second, false);
+        timing("hasCycle", cyc, false);
+        timing("topoOrder", topo, false);
+        timing("cyclicGroups", scc, false);
+        timing("courseLevels", lvl, false);
+        timing("eligibility1024", elig, false);
+        timing("eligibility1024_scalar", eligScalar, true);
+        o << "  },\n  \"lookups\": [\n";
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Row& r = rows[i];
+            o << "    { \"workload\": \"" << r.workload << "\", \"structure\": \"" << r.structure << "\", ";
+            if (r.skipped) o << "\"skipped\": true }";
+            else {
+                o << "\"p50_ns\": " << r.st.p50 << ", \"p99_ns\": " << r.st.p99 << ", \"p999_ns\": " << r.st.p999
+                    << ", \"max_ns\": " << r.st.max << ", \"mean_ns\": " << r.st.mean << ", \"batch_ns_per_op\": " << r.st.batchNs
+                    << ", \"allocs_per_op\": " << setprecision(3) << r.st.allocs << setprecision(1) << ", \"hits\": " << r.st.hits << ", \"check\": " << r.st.check % 1000000 << " }";
             }
-            // ensures each course appears as a vertex
-            if (!graph.count(c.courseNumber)) graph[c.courseNumber] = {};
+            o << (i + 1 < rows.size() ? ",\n" : "\n");
         }
+        o << "  ]\n}\n";
+        return true;
+    }
 
-        loaded = true;
-        cout << "Courses loaded (" << vec.size() << ").\n";
-        if (!malformedRows.empty() || !missingPrereqs.empty()) {
-            cout << "\n=== CSV Warnings ===\n";
-            for (const auto& m : malformedRows) cout << m << '\n';
-            for (const auto& miss : missingPrereqs)
-                cout << "Missing prereq: " << miss.first << " requires " << miss.second << " (not found)\n";
-            cout << "====================\n\n";
+    cout << fixed << setprecision(2);
+    cout << "Benchmark suite: " << n << " courses, " << ops << " ops per workload (timer overhead ~"
+        << setprecision(0) << timerNs << " ns)\n" << setprecision(2);
+    cout << "loadAll      best " << load.best << " ms, median " << load.median << " ms\n";
+    for (const auto& p : policyLoads)
+        cout << "  " << left << setw(17) << p.first + 8 << right << "best " << p.second.best << " ms, median " << p.second.median << " ms\n";
+    cout << "hasCycle     best " << cyc.best << " ms, median " << cyc.median << " ms\n";
+    cout << "topoOrder    best " << topo.best << " ms, median " << topo.median << " ms\n";
+    cout << "cyclicGroups best " << scc.best << " ms, median " << scc.median << " ms\n";
+    cout << "courseLevels best " << lvl.best << " ms, median " << lvl.median << " ms\n";
+    cout << "eligibility  best " << elig.best << " ms, median " << elig.median << " ms (1024 transcripts; one at a time: best "
+        << eligScalar.best << " ms)\n\n";
+    cout << setprecision(0);
+    cout << left << setw(12) << "workload" << setw(11) << "structure" << right << setw(9) << "p50 ns" << setw(9) << "p99 ns"
+        << setw(10) << "p999 ns" << setw(10) << "ns/op" << setw(11) << "allocs/op" << setw(9) << "hits" << '\n';
+    for (const Row& r : rows) {
+        cout << left << setw(12) << r.workload << setw(11) << r.structure << right;
+        if (r.skipped) { cout << "  (skipped: linear scan over " << n << " courses)\n"; continue; }
+        cout << setw(9) << r.st.p50 << setw(9) << r.st.p99 << setw(10) << r.st.p999 << setw(10) << r.st.batchNs
+            << setw(11) << setprecision(2) << r.st.allocs << setprecision(0) << setw(9) << r.st.hits << '\n';
+    }
+    cout << defaultfloat << setprecision(6) << '\n';
+    return true;
+}
+
+// load statistics
+
+// Phase timings of the last recorded load (see LoadStats), then the heap bytes held by
+// each structure and the shape of the trees and the hash index. Sizes of hash tables
+// are estimates; snapshot-backed arrays are counted once, as the mapping.
+static void printStats(const CourseCatalog& cat, ostream& out, bool json) {
+    const size_t n = cat.courseCount();
+    struct Mem { const char* name; size_t bytes; };
+    size_t levelBytes = cat.levelsReady
+        ? (cat.levels.level.capacity() + cat.levels.height.capacity() + cat.levels.byLevel.capacity() + cat.levels.levelAt.capacity()) * sizeof(uint32_t)
+        : 0;
+    const vector<Mem> mem = {
+        { "courses", cat.courses.capacity() * sizeof(Course) },
+        { "text pools", cat.titlePool.capacity() + cat.prereqPool.capacity() * sizeof(uint32_t) },
+        { "code table", cat.codes.memoryBytes() },
+        { "hmap", hashTableBytes(cat.hmap) },
+        { "bst", cat.bst.memoryBytes() },
+        { "avl", cat.avl.memoryBytes() },
+        { "sorted ids", cat.byCode.heapBytes() },
+        { "eytzinger", cat.sindex.memoryBytes() },
+        { "title index", cat.titleIndex.memoryBytes() },
+        { "graph", cat.graph.memoryBytes() },
+        { "rgraph", cat.rgraph.memoryBytes() },
+        { "closure memo", cat.closure.memoryBytes() },
+        { "levels", levelBytes },
+        { "eligibility", cat.eligibilityReady ? cat.eligibilityEngine.memoryBytes() : 0 },
+        { "impact", cat.impactSearch.memoryBytes() },
+        { "snapshot map", cat.snapshotFile ? cat.snapshotFile->view().size() : 0 },
+    };
+    size_t totalBytes = 0;
+    for (const Mem& m : mem) totalBytes += m.bytes;
+
+    size_t longestBucket = 0, emptyBuckets = 0;
+    for (size_t b = 0; b < cat.hmap.bucket_count(); ++b) {
+        size_t s = cat.hmap.bucket_size(b);
+        longestBucket = max(longestBucket, s);
+        emptyBuckets += s == 0;
+    }
+    const int ideal = n ? (int)ceil(log2((double)n + 1)) : 0;
+    size_t inlineCodes = 0, inlineLists = 0;
+    for (const Course& c : cat.courses) {
+        if (c.removed) continue;
+        inlineCodes += c.courseNumber().size() <= Course::CODE_INLINE;
+        inlineLists += c.prerequisites().size() <= Course::PREREQ_INLINE;
+    }
+    const double codesIn = n ? 100.0 * inlineCodes / n : 0, listsIn = n ? 100.0 * inlineLists / n : 0;
+
+    if (json) {
+        out << fixed << setprecision(3);
+        out << "{\n  \"source\": \"" << jsonEscape(cat.sourceFile) << "\",\n  \"courses\": " << n
+            << ",\n  \"edges\": " << cat.graph.edges() << ",\n  \"load_threads\": " << cat.loadThreads << ",\n  \"phases\": [";
+        for (size_t i = 0; i < cat.stats.phases.size(); ++i) {
+            const LoadStats::Phase& p = cat.stats.phases[i];
+            out << (i ? ",\n" : "\n") << "    { \"name\": \"" << jsonEscape(trimView(p.name)) << "\", \"ms\": " << p.ms
+                << ", \"allocs\": " << p.allocs << ", \"bytes\": " << p.bytes << " }";
         }
-        return true;
+        out << (cat.stats.phases.empty() ? "],\n" : "\n  ],\n") << "  \"memory\": {";
+        for (size_t i = 0; i < mem.size(); ++i) out << (i ? ", " : " ") << '"' << mem[i].name << "\": " << mem[i].bytes;
+        out << " },\n  \"memory_total\": " << totalBytes << ",\n  \"bytes_per_course\": " << (n ? (double)totalBytes / n : 0.0)
+            << ",\n  \"record\": { \"bytes\": " << sizeof(Course) << ", \"inline_codes_pct\": " << codesIn
+            << ", \"inline_prereqs_pct\": " << listsIn << " }"
+            << ",\n  \"bst\": { \"nodes\": " << cat.bst.nodeCount() << ", \"height\": " << cat.bst.height() << " }"
+            << ",\n  \"avl\": { \"nodes\": " << cat.avl.nodeCount() << ", \"height\": " << cat.avl.height() << " }"
+            << ",\n  \"min_height\": " << ideal
+            << ",\n  \"hmap\": { \"size\": " << cat.hmap.size() << ", \"buckets\": " << cat.hmap.bucket_count()
+            << ", \"load_factor\": " << cat.hmap.load_factor() << ", \"longest_bucket\": " << longestBucket
+            << ", \"empty_buckets\": " << emptyBuckets << " }\n}\n";
+        out << defaultfloat << setprecision(6);
+        return;
     }
 
-    // search helpers
-    const Course* findVector(const string& key) const {
-        for (const auto& c : vec) if (c.courseNumber == key) return &c;
-        return nullptr;
+    out << fixed << setprecision(2);
+    out << "Catalog: " << n << " courses, " << cat.graph.edges() << " prerequisite edges (" << cat.sourceFile << ")\n\n";
+    if (cat.stats.phases.empty()) out << "No load phases recorded.\n\n";
+    else {
+        out << left << setw(26) << "phase" << right << setw(10) << "ms" << setw(12) << "allocs" << setw(12) << "alloc MB" << '\n';
+        for (const LoadStats::Phase& p : cat.stats.phases)
+            out << left << setw(26) << p.name << right << setw(10) << p.ms << setw(12) << p.allocs << setw(12) << p.bytes / 1048576.0 << '\n';
+        out << '\n';
     }
-    const Course* findHash(const string& key) const {
-        auto it = hmap.find(key);
-        return it == hmap.end() ? nullptr : &it->second;
+    out << left << setw(16) << "structure" << right << setw(12) << "MB" << setw(14) << "bytes/course" << '\n';
+    for (const Mem& m : mem) {
+        if (!m.bytes) continue;
+        out << left << setw(16) << m.name << right << setw(12) << m.bytes / 1048576.0 << setw(14) << (n ? (double)m.bytes / n : 0.0) << '\n';
     }
-    const Course* findBST(const string& key) const { return bst.search(key); }
-    const Course* findAVL(const string& key) const { return avl.search(key); }
+    out << left << setw(16) << "total" << right << setw(12) << totalBytes / 1048576.0 << setw(14) << (n ? (double)totalBytes / n : 0.0) << "\n\n";
+    out << "course record " << sizeof(Course) << " bytes: code inline for " << codesIn << "% of courses, prerequisites for "
+        << listsIn << "% (up to " << Course::PREREQ_INLINE << ")\n";
+    out << "bst height " << cat.bst.height() << ", avl height " << cat.avl.height() << " (" << cat.avl.nodeCount()
+        << " nodes; minimum " << ideal << ")\n";
+    out << "hmap " << cat.hmap.size() << " keys in " << cat.hmap.bucket_count() << " buckets: load factor "
+        << cat.hmap.load_factor() << ", longest bucket " << longestBucket << ", " << emptyBuckets << " empty\n\n";
+    out << defaultfloat << setprecision(6);
+}
 
-    // graph algos
+// batch queries
+
+enum class BatchFormat { Text, Json };
 
-    // DFS cycle detection (returns any cycle path found)
-    bool hasCycle() const {
-        enum State { UNVIS = 0, VISITING = 1, VISITED = 2 };
-        unordered_map<string, int> state;
-        for (auto& kv : graph) state[kv.first] = UNVIS;
-
-        function<bool(const string&)> dfs = [&](const string& u)->bool {
-            state[u] = VISITING;
-            auto it = graph.find(u);
-            if (it != graph.end()) {
-                for (const auto& v : it->second) {
-                    if (state[v] == VISITING) return true;        // back-edge
-                    if (state[v] == UNVIS && dfs(v)) return true; // deeper cycle
+// Answers one query per input line and streams the answers through a 1 MB buffer. A line
+// is a course number, "chain CODE" (every prerequisite, direct or not), "list" (every
+// course by number), "topo" (a valid course order), "prefix CSCI3" (numbers starting
+// with it), "search WORDS" (titles with every word), "critical" (the longest
+// prerequisite chain), "plan CAP [CODE,...] [done CODE,...]" (terms of at most CAP
+// courses for those targets, or the whole catalog) or "eligible [CODE,...]" (courses a
+// student with that transcript can take next) or "impact CODE[,...]" (every course that
+// needs one of them, directly or not). Every listing is by course number. Runs of
+// eligible or impact lines are answered together in shared passes. Json writes one
+// object per line. Returns the number of queries answered.
+template <class Catalog>
+static size_t runBatch(Catalog& cat, string_view input, BatchFormat fmt, ostream& out) {
+    const bool json = fmt == BatchFormat::Json;
+    string buf;
+    buf.reserve((1 << 20) + 4096);
+    auto flush = [&](bool force) {
+        if (!force && buf.size() < (1 << 20)) return;
+        out.write(buf.data(), (streamsize)buf.size());
+        buf.clear();
+        };
+    auto str = [&](string_view s) {                     // JSON string literal
+        buf += '"';
+        appendJsonEscaped(buf, s);
+        buf += '"';
+        };
+    auto idList = [&](const char* label, const uint32_t* b, const uint32_t* e) {
+        if (json) {
+            buf += ",\""; buf += label; buf += "\":[";
+            for (const uint32_t* p = b; p != e; ++p) { if (p != b) buf += ','; str(cat.codeOf(*p)); }
+            buf += ']';
+            return;
+        }
+        buf += label[0] == 'p' ? "Prerequisites: " : "All prerequisites: ";
+        if (b == e) buf += "None";
+        for (const uint32_t* p = b; p != e; ++p) { if (p != b) buf += ", "; buf += cat.codeOf(*p); }
+        buf += '\n';
+        };
+
+    auto byCode = [&](vector<uint32_t>& ids) {
+        sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) { return cat.codeOf(a) < cat.codeOf(b); });
+        };
+
+    // Eligible and impact queries wait here until a query of another kind (or the end)
+    // needs the output; a run of them is answered in shared passes.
+    string_view heldVerb;
+    vector<string_view> heldLines;
+    vector<string> heldErrors;
+    vector<vector<uint32_t>> heldIds;                   // transcripts or impact sources
+    vector<uint32_t> codeRank;                          // id -> place in code order, built on first use
+    string rankText;                                    // every code, in code order
+    vector<string_view> rankCode;                       // place in code order -> code (into rankText)
+    vector<uint64_t> rankBits;                          // one bit per place; all zero between answers
+    vector<uint32_t> places;                            // a short answer, as sorted places
+    auto answerHeld = [&] {
+        if (heldLines.empty()) return;
+        if (codeRank.empty()) {
+            const FlatArray<uint32_t>& order = cat.codeOrder();
+            codeRank.assign(cat.courses.size(), UINT32_MAX);
+            rankCode.resize(order.size());
+            rankBits.assign(order.size() / 64 + 1, 0);
+            for (uint32_t r = 0; r < order.size(); ++r) { codeRank[order[r]] = r; rankText += cat.codeOf(order[r]); }
+            for (uint32_t r = 0, at = 0; r < order.size(); at += (uint32_t)cat.codeOf(order[r]).size(), ++r)
+                rankCode[r] = string_view(rankText.data() + at, cat.codeOf(order[r]).size());
+        }
+        // An answer is put in code order through its places: a long one (eligible often
+        // names a good part of the catalog) sets them in rankBits and is read back word by
+        // word, a short one is sorted. Either way the codes come out of rankCode in order.
+        auto collect = [&](size_t n, auto forEach) {
+            bool inBits = n * 64 >= rankCode.size();
+            places.clear();
+            if (inBits) forEach([&](uint32_t id) { rankBits[codeRank[id] >> 6] |= 1ull << (codeRank[id] & 63); });
+            else {
+                forEach([&](uint32_t id) { places.push_back(codeRank[id]); });
+                sort(places.begin(), places.end());
+            }
+            return inBits;
+            };
+        auto reply = [&](size_t i, size_t n, bool inBits) {
+            auto each = [&](auto f) {                   // every place in order; leaves rankBits zero
+                if (!inBits) { for (uint32_t r : places) f(rankCode[r]); return; }
+                for (size_t w = 0; w < rankBits.size(); ++w) {
+                    for (uint64_t m = rankBits[w]; m; m &= m - 1) f(rankCode[w * 64 + lowestBit(m)]);
+                    rankBits[w] = 0;
                 }
+                };
+            const string& err = heldErrors[i];
+            bool first = true;
+            if (!err.empty()) each([](string_view) {});
+            if (json) {
+                buf += "{\"query\":"; str(heldLines[i]); buf += ",\"ok\":"; buf += err.empty() ? "true" : "false";
+                if (!err.empty()) { buf += ",\"error\":"; str(err); }
+                buf += ",\"courses\":[";
+                if (err.empty()) each([&](string_view code) { if (!first) buf += ','; first = false; str(code); flush(false); });
+                buf += "]}\n";
             }
-            state[u] = VISITED;
-            return false;
+            else if (!err.empty()) { buf += err; buf += "\n\n"; }
+            else {
+                buf += heldVerb == "eligible" ? "Eligible (" : "Downstream ("; buf += to_string(n); buf += "): ";
+                if (!n) buf += "None";
+                each([&](string_view code) { if (!first) buf += ", "; first = false; buf += code; flush(false); });
+                buf += "\n\n";
+            }
+            flush(false);
             };
+        if (heldVerb == "eligible") {
+            cat.eligibility().run(heldIds, [&](size_t i, const EligibilityEngine::Courses& courses) {
+                reply(i, courses.size(), collect(courses.size(), [&](auto g) { courses.forEach(g); }));
+                });
+        }
+        else {
+            cat.impact(heldIds, [&](size_t i, IdRange ids) {
+                reply(i, ids.size(), collect(ids.size(), [&](auto g) { for (uint32_t id : ids) g(id); }));
+                });
+        }
+        heldLines.clear();
+        heldErrors.clear();
+        heldIds.clear();
+        };
+
+    size_t queries = 0;
+    forEachLine(input, [&](string_view raw) {
+        string_view line = trimView(raw);
+        if (line.empty() || line[0] == '#') return;
+        ++queries;
+        size_t sp = line.find(' ');
+        string_view verb = line.substr(0, sp);
+        string_view arg = sp == string_view::npos ? string_view() : trimView(line.substr(sp + 1));
 
-        for (auto& kv : graph) {
-            if (state[kv.first] == UNVIS && dfs(kv.first)) return true;
+        if (verb == "eligible" || verb == "impact") {
+            if (verb != heldVerb) answerHeld();
+            heldVerb = verb;
+            heldLines.push_back(line);
+            heldErrors.emplace_back();
+            heldIds.emplace_back();
+            if (!cat.resolveCodes(arg, heldIds.back(), heldErrors.back())) heldIds.back().clear();
+            if (heldLines.size() >= 4096) answerHeld();
+            return;
         }
-        return false;
-    }
+        answerHeld();
 
-    // Kahn's algorithm for topological order
-    vector<string> topoOrder(bool& ok) const {
-        unordered_map<string, int> indeg;
-        for (auto& kv : graph) {
-            if (!indeg.count(kv.first)) indeg[kv.first] = 0;
-            for (auto& v : kv.second) indeg[v]++;
-        }
-        queue<string> q;
-        for (auto& kv : indeg) if (kv.second == 0) q.push(kv.first);
-
-        vector<string> order;
-        while (!q.empty()) {
-            string u = q.front(); q.pop();
-            order.push_back(u);
-            auto it = graph.find(u);
-            if (it != graph.end()) {
-                for (auto& v : it->second) {
-                    if (--indeg[v] == 0) q.push(v);
+        const bool listing = verb == "prefix" || verb == "search";
+        if (listing && arg.empty()) {
+            string err = string(verb) + ": Enter " + (verb == "prefix" ? "a course number prefix." : "at least one title word.");
+            if (json) { buf += "{\"query\":"; str(line); buf += ",\"ok\":false,\"error\":"; str(err); buf += ",\"courses\":[]}\n"; }
+            else { buf += err; buf += "\n\n"; }
+            flush(false);
+            return;
+        }
+        if (verb == "list" || verb == "topo" || listing) {
+            vector<uint32_t> ids;
+            bool ok = true;
+            if (verb == "topo") ids = cat.topoOrder(ok);
+            else if (verb == "list") ids.assign(cat.codeOrder().begin(), cat.codeOrder().end());
+            else if (verb == "prefix") { IdRange r = cat.findPrefix(arg); ids.assign(r.begin(), r.end()); }
+            else { ids = cat.searchTitles(arg); byCode(ids); }
+            if (json) {
+                buf += "{\"query\":"; str(line); buf += ",\"ok\":"; buf += ok ? "true" : "false";
+                idList("courses", ids.data(), ids.data() + ids.size());
+                buf += "}\n";
+            }
+            else if (!ok) buf += "Cannot print topological order: cycle(s) present.\n\n";
+            else {
+                for (uint32_t id : ids) {
+                    buf += cat.codeOf(id);
+                    if (verb != "topo") { buf += ", "; buf += cat.courses[id].courseTitle(); }
+                    buf += '\n';
+                    flush(false);
                 }
+                buf += '\n';
             }
+            flush(false);
+            return;
         }
-        ok = (order.size() == indeg.size());
-        return order;
-    }
 
-    // benchmarking search time
-    void benchmarkSearches(size_t repeatsPerKey = 200) {
-        if (!loaded) { cout << "Load data first.\n\n"; return; }
-        if (vec.empty()) { cout << "No data.\n\n"; return; }
+        if (verb == "critical") {
+            vector<uint32_t> path = cat.criticalPath();
+            if (json) { buf += "{\"query\":"; str(line); idList("courses", path.data(), path.data() + path.size()); buf += "}\n"; }
+            else if (path.empty()) buf += "No acyclic prerequisite chain (every course is on or behind a cycle).\n\n";
+            else {
+                buf += "Longest prerequisite chain ("; buf += to_string(path.size()); buf += " courses): ";
+                for (size_t i = 0; i < path.size(); ++i) { if (i) buf += " -> "; buf += cat.codeOf(path[i]); }
+                buf += "\n\n";
+            }
+            flush(false);
+            return;
+        }
 
-        vector<string> keys;
-        keys.reserve(vec.size());
-        for (const auto& c : vec) keys.push_back(c.courseNumber);
+        if (verb == "plan" && !arg.empty()) {
+            // plan CAP [TARGET,...] [done COMPLETED,...]
+            size_t capEnd = arg.find(' ');
+            string_view rest = capEnd == string_view::npos ? string_view() : trimView(arg.substr(capEnd + 1));
+            string_view targets = rest, completed;
+            size_t d = rest.substr(0, 4) == "done" ? 0 : rest.find(" done");
+            if (d != string_view::npos) { targets = rest.substr(0, d); completed = trimView(rest.substr(d + (d ? 5 : 4))); }
+            string_view capText = arg.substr(0, capEnd);
+            uint32_t cap = 0;
+            auto [capStop, capErr] = from_chars(capText.data(), capText.data() + capText.size(), cap);
+            vector<uint32_t> want, done;
+            string err;
+            bool ok = capErr == errc() && capStop == capText.data() + capText.size();
+            if (!ok) err = string(capText) + ": Not a course count (0 means no cap).";
+            ok = ok && cat.resolveCodes(targets, want, err) && cat.resolveCodes(completed, done, err);
+            SemesterPlan plan;
+            if (ok) plan = cat.planSemesters(want, done, cap);
+            for (auto& t : plan.terms) byCode(t);
+            byCode(plan.blocked);
+            if (json) {
+                buf += "{\"query\":"; str(line); buf += ",\"ok\":"; buf += ok ? "true" : "false";
+                if (!ok) { buf += ",\"error\":"; str(err); }
+                buf += ",\"longest_chain\":"; buf += to_string(plan.criticalLength);
+                buf += ",\"terms\":[";
+                for (size_t t = 0; t < plan.terms.size(); ++t) {
+                    if (t) buf += ',';
+                    buf += '[';
+                    for (size_t i = 0; i < plan.terms[t].size(); ++i) { if (i) buf += ','; str(cat.codeOf(plan.terms[t][i])); }
+                    buf += ']';
+                    flush(false);
+                }
+                buf += ']';
+                idList("blocked", plan.blocked.data(), plan.blocked.data() + plan.blocked.size());
+                buf += "}\n";
+            }
+            else if (!ok) { buf += err; buf += "\n\n"; }
+            else {
+                buf += "Plan: "; buf += to_string(plan.terms.size()); buf += " terms, longest chain ";
+                buf += to_string(plan.criticalLength); buf += '\n';
+                for (size_t t = 0; t < plan.terms.size(); ++t) {
+                    buf += "Term "; buf += to_string(t + 1); buf += ": ";
+                    for (size_t i = 0; i < plan.terms[t].size(); ++i) { if (i) buf += ", "; buf += cat.codeOf(plan.terms[t][i]); }
+                    buf += '\n';
+                    flush(false);
+                }
+                if (!plan.blocked.empty()) {
+                    buf += "Cannot be scheduled (prerequisite cycle): ";
+                    for (size_t i = 0; i < plan.blocked.size(); ++i) { if (i) buf += ", "; buf += cat.codeOf(plan.blocked[i]); }
+                    buf += '\n';
+                }
+                buf += '\n';
+            }
+            flush(false);
+            return;
+        }
 
-        auto bench = [&](const string& name, auto finder) {
-            using clock = chrono::high_resolution_clock;
-            auto t0 = clock::now();
-            size_t hits = 0;
-            for (const auto& k : keys) {
-                for (size_t r = 0; r < repeatsPerKey; ++r) {
-                    hits += (finder(k) != nullptr);
+        const bool chain = verb == "chain" && !arg.empty();
+        const Course* c = cat.find(chain ? arg : line); // straight from the input buffer, any case
+        if (json) {
+            buf += "{\"query\":"; str(line); buf += ",\"found\":"; buf += c ? "true" : "false";
+            if (c) {
+                buf += ",\"number\":"; str(c->courseNumber());
+                buf += ",\"title\":"; str(c->courseTitle());
+                idList("prerequisites", c->prerequisites().begin(), c->prerequisites().end());
+                if (chain) {
+                    auto all = cat.allPrereqs(c->id);
+                    byCode(all.ids);
+                    idList("all_prerequisites", all.ids.data(), all.ids.data() + all.ids.size());
+                    buf += ",\"depth\":"; buf += to_string(all.depth);
                 }
             }
-            auto t1 = clock::now();
-            auto us = chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
-            cout << name << " total: " << us << " us (microseconds)"
-                << "  (checks: " << hits << ")\n";
-            };
+            buf += "}\n";
+        }
+        else if (!c) { buf += chain ? arg : line; buf += ": Course not found.\n\n"; }
+        else {
+            buf += c->courseNumber(); buf += ", "; buf += c->courseTitle(); buf += '\n';
+            idList("prerequisites", c->prerequisites().begin(), c->prerequisites().end());
+            if (chain) {
+                auto all = cat.allPrereqs(c->id);
+                byCode(all.ids);
+                idList("all", all.ids.data(), all.ids.data() + all.ids.size());
+                buf += "Longest prerequisite chain: "; buf += to_string(all.depth); buf += '\n';
+            }
+            buf += '\n';
+        }
+        flush(false);
+        });
+    answerHeld();
+    flush(true);
+    out.flush();
+    return queries;
+}
 
-        cout << "Benchmarking search (" << keys.size() << " keys x " << repeatsPerKey << " reps)...\n";
-        bench("Vector (linear)", [this](const string& k) { return this->findVector(k); });
-        bench("BST (unbalanced)", [this](const string& k) { return this->findBST(k); });
-        bench("AVL (balanced)", [this](const string& k) { return this->findAVL(k); });
-        bench("Hash (unordered_map)", [this](const string& k) { return this->findHash(k); });
-        cout << '\n';
-    }
-};
+// --batch: answers go to `out`, the load error and throughput report to `report`. The
+// batch commands never edit, so the serving catalog builds only the hash index; it is
+// loaded quietly, from the snapshot when `like` names one.
+static bool loadServing(ServingCatalog& serving, const CourseCatalog& like, ostream& report) {
+    serving.sourceFile = like.sourceFile;
+    serving.snapshotPath = like.snapshotPath;
+    serving.loadThreads = like.loadThreads;
+    serving.quiet = true;
+    if (serving.loadAll()) return true;
+    report << "Error loading " << serving.sourceFile << '\n';
+    return false;
+}
+
+static size_t serveBatch(ServingCatalog& serving, string_view input, BatchFormat fmt, ostream& out, ostream& report) {
+    auto t0 = chrono::steady_clock::now();
+    size_t n = runBatch(serving, input, fmt, out);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    report << n << " queries in " << secs * 1000 << " ms (" << (size_t)(n / max(secs, 1e-9)) << " per second)\n";
+    return n;
+}
 
 // menu
 
+// Options 1-6 and 9 keep their numbers; newer features live in the two submenus, so
+// adding one never renumbers what people (and scripts) already type.
 static void displayMenu() {
     cout << "1. Load Data Structures\n";
     cout << "2. Print Course List (alphabetical)\n";
@@ -383,25 +4445,227 @@ static void displayMenu() {
     cout << "4. Validate Prerequisites (missing & cycles)\n";
     cout << "5. Print Topological Order\n";
     cout << "6. Benchmark Searches\n";
+    cout << "7. Course Tools...\n";
+    cout << "8. More Benchmarks...\n";
     cout << "9. Exit\n";
 }
 
-static void printCourseInfo(const CourseCatalog& cat, const string& code) {
-    const Course* c = cat.findHash(code); // fast path by default
+static const size_t TOOL_COUNT = 7, BENCHMARK_COUNT = 3;
+
+static void displayToolsMenu() {
+    cout << "  1. Print Full Prerequisite Chain\n";
+    cout << "  2. Search Courses (number prefix or title words)\n";
+    cout << "  3. Edit Catalog\n";
+    cout << "  4. Plan Semesters\n";
+    cout << "  5. Courses Available Next\n";
+    cout << "  6. Downstream Impact\n";
+    cout << "  7. Show Load Statistics\n";
+    cout << "  0. Back\n";
+}
+
+static void displayBenchmarkMenu() {
+    cout << "  1. Benchmark CSV Loading\n";
+    cout << "  2. Benchmark Graph Algorithms\n";
+    cout << "  3. Benchmark Concurrent Queries\n";
+    cout << "  0. Back\n";
+}
+
+template <class Catalog>
+static void printCourseInfo(const Catalog& cat, string_view code) {
+    const Course* c = cat.find(code); // fast path by default
     if (!c) { cout << "Course not found.\n\n"; return; }
-    cout << c->courseNumber << ", " << c->courseTitle << '\n';
-    if (c->prerequisites.empty()) {
+    cout << c->courseNumber() << ", " << c->courseTitle() << '\n';
+    if (c->prerequisites().empty()) {
         cout << "Prerequisites: None\n\n";
     }
     else {
         cout << "Prerequisites: ";
-        for (size_t i = 0; i < c->prerequisites.size(); ++i) {
-            cout << c->prerequisites[i] << (i + 1 < c->prerequisites.size() ? ", " : "");
+        for (size_t i = 0; i < c->prerequisites().size(); ++i) {
+            cout << cat.codeOf(c->prerequisites()[i]) << (i + 1 < c->prerequisites().size() ? ", " : "");
         }
         cout << "\n\n";
     }
 }
 
+// transitive prerequisites of one course, listed alphabetically
+static void printPrereqChain(CourseCatalog& cat, string_view code) {
+    const Course* c = cat.find(code);
+    if (!c) { cout << "Course not found.\n\n"; return; }
+    using clock = chrono::steady_clock;
+    auto t0 = clock::now();
+    CourseCatalog::PrereqChain chain = cat.allPrereqs(c->id);
+    double us = chrono::duration<double, micro>(clock::now() - t0).count();
+
+    cout << c->courseNumber() << ", " << c->courseTitle() << '\n';
+    if (chain.ids.empty()) { cout << "Prerequisites: None\n\n"; return; }
+    vector<string_view> names;
+    names.reserve(chain.ids.size());
+    for (uint32_t id : chain.ids) names.push_back(cat.codeOf(id));
+    sort(names.begin(), names.end());
+    const size_t shown = 200;
+    cout << "All prerequisites (" << names.size() << "): ";
+    for (size_t i = 0; i < names.size() && i < shown; ++i) cout << (i ? ", " : "") << names[i];
+    cout << (names.size() > shown ? ", ..." : "") << '\n';
+    cout << "Longest prerequisite chain: " << chain.depth << " course" << (chain.depth == 1 ? "" : "s") << '\n';
+    if (chain.cyclic) cout << "Warning: " << c->courseNumber() << " is part of a prerequisite cycle.\n";
+    cout << "(" << us << " us)\n\n";
+}
+
+// A single word is also tried as a course number prefix; every query is matched against
+// title words. At most 50 results per kind are listed.
+static void searchCourses(CourseCatalog& cat, const string& query) {
+    if (query.empty()) return;
+    using clock = chrono::steady_clock;
+    const size_t shown = 50;
+    auto list = [&](const char* what, const uint32_t* b, const uint32_t* e, double us) {
+        size_t n = (size_t)(e - b);
+        cout << what << " (" << n << ", " << us << " us):\n";
+        for (const uint32_t* p = b; p != e && p - b < (ptrdiff_t)shown; ++p)
+            cout << "  " << cat.courses[*p].courseNumber() << ", " << cat.courses[*p].courseTitle() << '\n';
+        if (n > shown) cout << "  ... " << n - shown << " more\n";
+        };
+    if (query.find(' ') == string::npos && query.back() != '*') {
+        auto t0 = clock::now();
+        IdRange r = cat.findPrefix(query);
+        list("Course numbers starting with that", r.begin(), r.end(), chrono::duration<double, micro>(clock::now() - t0).count());
+    }
+    auto t0 = clock::now();
+    vector<uint32_t> ids = cat.searchTitles(query);
+    double us = chrono::duration<double, micro>(clock::now() - t0).count();
+    sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) { return cat.codeOf(a) < cat.codeOf(b); });
+    list("Titles with those words", ids.data(), ids.data() + ids.size(), us);
+    cout << '\n';
+}
+
+// Semester plan for one student. `targets` and `completed` are comma separated course
+// numbers; no targets plans the whole catalog. Only the first 40 terms are listed.
+static void printSemesterPlan(CourseCatalog& cat, uint32_t maxPerTerm, const string& targets, const string& completed) {
+    using clock = chrono::steady_clock;
+    const size_t shownTerms = 40, shown = 20;
+    vector<uint32_t> want, done;
+    string err;
+    if (!cat.resolveCodes(targets, want, err) || !cat.resolveCodes(completed, done, err)) { cout << err << "\n\n"; return; }
+    auto t0 = clock::now();
+    SemesterPlan plan = cat.planSemesters(want, done, maxPerTerm);
+    double ms = chrono::duration<double, milli>(clock::now() - t0).count();
+    auto list = [&](vector<uint32_t> ids, const char* sep) {
+        sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) { return cat.codeOf(a) < cat.codeOf(b); });
+        for (size_t i = 0; i < ids.size() && i < shown; ++i) cout << (i ? sep : "") << cat.codeOf(ids[i]);
+        if (ids.size() > shown) cout << sep << "... (" << ids.size() - shown << " more)";
+        cout << '\n';
+        };
+
+    size_t planned = 0;
+    for (const auto& t : plan.terms) planned += t.size();
+    cout << "Plan: " << planned << " courses in " << plan.terms.size() << " terms (";
+    if (maxPerTerm) cout << "at most " << maxPerTerm << " per term, ";
+    cout << "longest chain " << plan.criticalLength << " courses; " << ms << " ms)\n";
+    if (want.empty()) {
+        vector<uint32_t> path = cat.criticalPath();
+        if (path.empty()) cout << "No acyclic prerequisite chain (every course is on or behind a cycle).\n";
+        else {
+            cout << "Critical path: ";
+            for (size_t i = 0; i < path.size() && i < shown; ++i) cout << (i ? " -> " : "") << cat.codeOf(path[i]);
+            cout << (path.size() > shown ? " -> ...\n" : "\n");
+        }
+    }
+    for (size_t t = 0; t < plan.terms.size() && t < shownTerms; ++t) {
+        cout << "Term " << t + 1 << ": ";
+        list(plan.terms[t], ", ");
+    }
+    if (plan.terms.size() > shownTerms) cout << "... " << plan.terms.size() - shownTerms << " more terms\n";
+    if (!plan.blocked.empty()) {
+        cout << "Cannot be scheduled (prerequisite cycle): ";
+        list(plan.blocked, ", ");
+    }
+    cout << '\n';
+}
+
+// Courses a student who has passed `completed` (comma separated) can take now, listed
+// alphabetically; only the first 50 are shown.
+static void printEligible(CourseCatalog& cat, const string& completed) {
+    using clock = chrono::steady_clock;
+    const size_t shown = 50;
+    vector<uint32_t> done;
+    string err;
+    if (!cat.resolveCodes(completed, done, err)) { cout << err << "\n\n"; return; }
+    auto t0 = clock::now();
+    vector<uint32_t> ids = cat.eligibility().eligible(done);
+    double us = chrono::duration<double, micro>(clock::now() - t0).count();
+    sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) { return cat.codeOf(a) < cat.codeOf(b); });
+    cout << "Available next (" << ids.size() << ", " << us << " us):\n";
+    for (size_t i = 0; i < ids.size() && i < shown; ++i)
+        cout << "  " << cat.courses[ids[i]].courseNumber() << ", " << cat.courses[ids[i]].courseTitle() << '\n';
+    if (ids.size() > shown) cout << "  ... " << ids.size() - shown << " more\n";
+    cout << '\n';
+}
+
+// Every course that needs one of `codes` (comma separated), directly or not, listed
+// alphabetically; only the first 50 are shown.
+static void printImpact(CourseCatalog& cat, const string& codes) {
+    using clock = chrono::steady_clock;
+    const size_t shown = 50;
+    vector<vector<uint32_t>> sources(1);
+    string err;
+    if (!cat.resolveCodes(codes, sources[0], err)) { cout << err << "\n\n"; return; }
+    if (sources[0].empty()) { cout << "Enter at least one course number.\n\n"; return; }
+    auto t0 = clock::now();
+    vector<uint32_t> ids;
+    cat.impact(sources, [&](size_t, IdRange r) { ids.assign(r.begin(), r.end()); });
+    double us = chrono::duration<double, micro>(clock::now() - t0).count();
+    sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) { return cat.codeOf(a) < cat.codeOf(b); });
+    // the last level expanded reaches nothing new
+    cout << "Downstream (" << ids.size() << ", up to " << cat.impactSearch.levels - 1 << " steps away, " << us << " us):\n";
+    for (size_t i = 0; i < ids.size() && i < shown; ++i)
+        cout << "  " << cat.courses[ids[i]].courseNumber() << ", " << cat.courses[ids[i]].courseTitle() << '\n';
+    if (ids.size() > shown) cout << "  ... " << ids.size() - shown << " more\n";
+    cout << '\n';
+}
+
+// one edit command:
+//   add CODE,Title[,PREREQ...]     update CODE,Title[,PREREQ...]     remove CODE
+//   require COURSE PREREQ          drop COURSE PREREQ
+static void runEditCommand(CourseCatalog& cat, const string& line) {
+    istringstream in(line);
+    string verb;
+    in >> verb;
+    verb = toUpper(verb);
+    string rest;
+    getline(in >> ws, rest);
+
+    vector<string_view> fields;
+    string_view row(rest);
+    for (size_t pos = 0; pos <= row.size();) {
+        size_t comma = min(row.find(',', pos), row.size());
+        fields.push_back(trimView(row.substr(pos, comma - pos)));
+        pos = comma + 1;
+    }
+    istringstream words(rest);
+    string a, b;
+    words >> a >> b;
+
+    using clock = chrono::steady_clock;
+    auto t0 = clock::now();
+    string err;
+    bool ok;
+    if (verb == "ADD" || verb == "UPDATE") {
+        if (fields.size() < 2) { cout << "Usage: " << (verb == "ADD" ? "add" : "update") << " CODE,Title[,PREREQ...]\n\n"; return; }
+        vector<string_view> prereqs(fields.begin() + 2, fields.end());
+        ok = verb == "ADD" ? cat.addCourse(fields[0], fields[1], prereqs, err) : cat.updateCourse(fields[0], fields[1], prereqs, err);
+    }
+    else if (verb == "REMOVE" && !a.empty()) ok = cat.removeCourse(a, err);
+    else if (verb == "REQUIRE" && !b.empty()) ok = cat.addPrereq(a, b, err);
+    else if (verb == "DROP" && !b.empty()) ok = cat.removePrereq(a, b, err);
+    else {
+        cout << "Commands: add CODE,Title[,PREREQ...] | update CODE,Title[,PREREQ...] | remove CODE\n"
+            << "          require COURSE PREREQ | drop COURSE PREREQ\n\n";
+        return;
+    }
+    double us = chrono::duration<double, micro>(clock::now() - t0).count();
+    if (ok) cout << "Done (" << us << " us). " << cat.courseCount() << " courses.\n\n";
+    else cout << "Not changed: " << err << ".\n\n";
+}
+
 static void processMenu(CourseCatalog& catalog) {
     while (true) {
         displayMenu();
@@ -409,6 +4673,25 @@ static void processMenu(CourseCatalog& catalog) {
         int choice;
         if (!(cin >> choice)) return;
         cout << '\n';
+        if (choice == 7 || choice == 8) {
+            // a submenu entry k runs as case 10 * choice + k (71 = first tool)
+            if (choice == 7) displayToolsMenu();
+            else displayBenchmarkMenu();
+            cout << "Which one? ";
+            int sub;
+            if (!(cin >> sub)) return;
+            cout << '\n';
+            if (sub == 0) continue;
+            if (sub < 0 || (size_t)sub > (choice == 7 ? TOOL_COUNT : BENCHMARK_COUNT)) {
+                cout << sub << " isn't a choice! Try again.\n\n";
+                continue;
+            }
+            choice = 10 * choice + sub;
+        }
+        else if (choice > 9) {                          // submenu cases are not top-level choices
+            cout << choice << " isn't a choice! Try again.\n\n";
+            continue;
+        }
 
         switch (choice) {
         case 1: {
@@ -424,22 +4707,39 @@ static void processMenu(CourseCatalog& catalog) {
         case 3: {
             if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
             cout << "What course would you like to know about? ";
-            string code; cin >> code; code = toUpper(code);
+            string code; cin >> code;                  // any case: lookups fold it
             cout << '\n';
             printCourseInfo(catalog, code);
             break;
         }
         case 4: {
             if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
-            bool cyc = catalog.hasCycle();
+            auto groups = catalog.cyclicGroups();
             if (!catalog.missingPrereqs.empty()) {
                 cout << "Missing prerequisite references detected (" << catalog.missingPrereqs.size() << ").\n";
             }
             else {
                 cout << "No missing prerequisite references.\n";
             }
-            cout << (cyc ? "Cycle detected in prerequisites (invalid DAG).\n\n"
-                : "No cycles detected (valid DAG).\n\n");
+            if (groups.empty()) {
+                cout << "No cycles detected (valid DAG).\n\n";
+                break;
+            }
+            cout << "Cycle detected in prerequisites (invalid DAG).\n";
+            const size_t shown = 20;
+            auto cycle = catalog.findCycle();
+            cout << "Example cycle (" << cycle.size() << " courses): ";
+            for (size_t i = 0; i < cycle.size() && i < shown; ++i) cout << catalog.codeOf(cycle[i]) << " -> ";
+            cout << (cycle.size() > shown ? "... -> " : "") << catalog.codeOf(cycle.front()) << '\n';
+            cout << "Cyclic course groups (" << groups.size() << "):\n";
+            for (size_t g = 0; g < groups.size() && g < shown; ++g) {
+                cout << "  [" << groups[g].size() << "] ";
+                for (size_t i = 0; i < groups[g].size() && i < shown; ++i)
+                    cout << (i ? ", " : "") << catalog.codeOf(groups[g][i]);
+                cout << (groups[g].size() > shown ? ", ...\n" : "\n");
+            }
+            if (groups.size() > shown) cout << "  ... " << groups.size() - shown << " more\n";
+            cout << '\n';
             break;
         }
         case 5: {
@@ -451,28 +4751,231 @@ static void processMenu(CourseCatalog& catalog) {
             }
             else {
                 cout << "Valid course order (prereqs first):\n\n";
-                for (const auto& c : order) cout << c << '\n';
+                for (uint32_t id : order) cout << catalog.codeOf(id) << '\n';
                 cout << '\n';
             }
             break;
         }
         case 6:
-            catalog.benchmarkSearches(); // uses current data
+            runBenchmarkSuite(catalog, BenchConfig(), nullptr); // on its own copy of the CSV
             break;
         case 9:
             cout << "Thank you for using the course planner!\n\n";
             return;
+        case 71: {
+            if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
+            cout << "Which course's full prerequisite chain? ";
+            string code; cin >> code;
+            cout << '\n';
+            printPrereqChain(catalog, code);
+            break;
+        }
+        case 72: {
+            if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
+            cout << "Search for (e.g. CSCI3, or Programming, or intro* data): ";
+            string query;
+            getline(cin >> ws, query);
+            cout << '\n';
+            searchCourses(catalog, query);
+            break;
+        }
+        case 73: {
+            if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
+            cout << "Edit (add CODE,Title,PREREQ... | update ... | remove CODE | require COURSE PREREQ | drop COURSE PREREQ): ";
+            string line;
+            getline(cin >> ws, line);
+            cout << '\n';
+            runEditCommand(catalog, line);
+            break;
+        }
+        case 74: {
+            if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
+            cout << "Most courses per term (0 = no limit)? ";
+            long long cap = 0;
+            if (!(cin >> cap) || cap < 0) {
+                if (cin.eof()) return;                  // only end of input quits
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "\nEnter a whole number of courses, 0 for no limit.\n\n";
+                break;
+            }
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            string targets, completed;
+            cout << "Courses to plan for (comma separated, blank = whole catalog)? ";
+            getline(cin, targets);
+            cout << "Courses already completed (comma separated, blank = none)? ";
+            getline(cin, completed);
+            cout << '\n';
+            printSemesterPlan(catalog, (uint32_t)min<long long>(cap, UINT32_MAX), targets, completed);
+            break;
+        }
+        case 75: {
+            if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            string completed;
+            cout << "Courses already completed (comma separated, blank = none)? ";
+            getline(cin, completed);
+            cout << '\n';
+            printEligible(catalog, completed);
+            break;
+        }
+        case 76: {
+            if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            string codes;
+            cout << "Courses that change (comma separated)? ";
+            getline(cin, codes);
+            cout << '\n';
+            printImpact(catalog, codes);
+            break;
+        }
+        case 77: {
+            if (!catalog.loaded) { cout << "Load data first.\n\n"; break; }
+            if (catalog.stats.phases.empty() && !catalog.edited) {
+                // the last load was not recorded: load again with the phase timers on
+                bool wasQuiet = catalog.quiet, wasEnabled = catalog.stats.enabled;
+                catalog.quiet = true;
+                catalog.stats.enabled = true;
+                catalog.loadAll();
+                catalog.quiet = wasQuiet;
+                catalog.stats.enabled = wasEnabled;
+            }
+            printStats(catalog, cout, false);
+            break;
+        }
+        case 81:
+            catalog.benchmarkLoad();
+            break;
+        case 82:
+            benchmarkGraph(); // synthetic, does not need loaded data
+            benchmarkImpact();
+            break;
+        case 83:
+            benchmarkQueries(catalog.sourceFile, catalog.loadThreads); // own copy of the catalog
+            break;
         default:
             cout << choice << " isn't a choice! Try again.\n\n";
         }
     }
 }
 
+// Lookup loop for --watch: every query reads whichever catalog is published at that
+// moment, while the watcher swaps in a new one whenever the CSV changes.
+static void serveWatched(LiveCatalog& live) {
+    cout << "Watching for changes. Enter a course number (blank line to quit).\n";
+    string line;
+    while (true) {
+        cout << "Course? " << flush;
+        if (!getline(cin, line)) break;
+        string_view code = trimView(line);
+        if (code.empty()) break;
+        LiveCatalog::Snapshot snap = live.current();   // held for this query only
+        cout << '\n';
+        printCourseInfo(*snap, code);
+    }
+    cout << "Thank you for using the course planner!\n\n";
+}
+
 // main
 
-int main() {
-    cout << "Welcome to the course planner.\n";
+int main(int argc, char* argv[]) {
     CourseCatalog catalog;
+    BenchConfig bench;
+    GenConfig gen;
+    string benchOut, genOut;
+    bool benchMode = false, watchMode = false, batchMode = false, statsMode = false;
+    string batchIn;
+    BatchFormat batchFormat = BatchFormat::Text;
+    // usage: planner [csv] [--threads N] [--snapshot FILE]
+    //        planner [csv] --bench [FILE.json] [--ops N] [--reps N] [--seed N]
+    //        planner [csv] --watch                  (hot reload: lookups only)
+    //        planner [csv] --batch [FILE|-] [--format text|json]
+    //        planner [csv] --stats [--format text|json]   (instrumented load, then the report)
+    //        planner --generate FILE.csv [--courses N] [--prereqs N] [--layers N]
+    //                [--order sorted|reverse|random] [--cycles N] [--missing N] [--malformed N] [--seed N]
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) catalog.loadThreads = (unsigned)max(1, atoi(argv[++i]));
+        else if (arg == "--snapshot" && i + 1 < argc) catalog.snapshotPath = argv[++i];
+        else if (arg == "--watch") watchMode = true;
+        else if (arg == "--stats") statsMode = true;
+        else if (arg == "--batch") {
+            batchMode = true;
+            if (i + 1 < argc && (argv[i + 1][0] != '-' || argv[i + 1][1] == '\0')) batchIn = argv[++i];
+        }
+        else if (arg == "--format" && i + 1 < argc) batchFormat = string(argv[++i]) == "json" ? BatchFormat::Json : BatchFormat::Text;
+        else if (arg == "--bench") {
+            benchMode = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') benchOut = argv[++i];
+        }
+        else if (arg == "--ops" && i + 1 < argc) bench.ops = (size_t)max(1, atoi(argv[++i]));
+        else if (arg == "--reps" && i + 1 < argc) bench.reps = (size_t)max(1, atoi(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) bench.seed = gen.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--generate" && i + 1 < argc) genOut = argv[++i];
+        else if (arg == "--courses" && i + 1 < argc) gen.courses = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--prereqs" && i + 1 < argc) gen.maxPrereqs = (uint32_t)max(0, atoi(argv[++i]));
+        else if (arg == "--layers" && i + 1 < argc) gen.layers = (uint32_t)max(1, atoi(argv[++i]));
+        else if (arg == "--order" && i + 1 < argc) gen.order = argv[++i];
+        else if (arg == "--cycles" && i + 1 < argc) gen.cycles = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--missing" && i + 1 < argc) gen.missing = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--malformed" && i + 1 < argc) gen.malformed = strtoull(argv[++i], nullptr, 10);
+        else catalog.sourceFile = arg;
+    }
+
+    if (!genOut.empty()) {
+        ofstream out(genOut, ios::binary);
+        if (!out || !generateCatalog(gen, out)) { cout << "Error writing " << genOut << " (check --order and --courses)\n"; return 1; }
+        cout << "Wrote " << gen.courses << " courses to " << genOut << ".\n";
+        return 0;
+    }
+
+    if (benchMode) {
+        if (benchOut.empty()) return runBenchmarkSuite(catalog, bench, &cout) ? 0 : 1;
+        ofstream out(benchOut);
+        if (!out) { cout << "Error writing " << benchOut << '\n'; return 1; }
+        bool ok = runBenchmarkSuite(catalog, bench, &out);
+        if (ok) cout << "Benchmark results written to " << benchOut << ".\n";
+        return ok ? 0 : 1;
+    }
+
+    if (statsMode) {
+        catalog.quiet = true;
+        catalog.stats.enabled = true;
+        if (!catalog.loadAll()) { cerr << "Error loading " << catalog.sourceFile << '\n'; return 1; }
+        printStats(catalog, cout, batchFormat == BatchFormat::Json);
+        return 0;
+    }
+
+    if (batchMode) {
+        ios::sync_with_stdio(false);
+        ServingCatalog serving;
+        if (!loadServing(serving, catalog, cerr)) return 1;
+        string stdinText;
+        unique_ptr<MappedFile> inFile;
+        string_view input;
+        if (batchIn.empty() || batchIn == "-") {
+            stdinText.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+            input = stdinText;
+        }
+        else {
+            inFile = make_unique<MappedFile>(batchIn);
+            if (!inFile->ok()) { cerr << "Error opening " << batchIn << '\n'; return 1; }
+            input = inFile->view();
+        }
+        serveBatch(serving, input, batchFormat, cout, cerr);
+        return 0;
+    }
+
+    cout << "Welcome to the course planner.\n";
+    if (watchMode) {
+        LiveCatalog live(catalog.sourceFile, catalog.loadThreads);
+        string why;
+        if (!live.reload(why)) { cout << "Error: " << why << '\n'; return 1; }
+        cout << "Courses loaded (" << live.current()->courses.size() << ").\n";
+        live.watch();
+        serveWatched(live);
+        return 0;
+    }
     processMenu(catalog);
     return 0;
 }
@@ -0,0 +1,909 @@
+﻿// Regression checks for the course planner. The planner is one translation unit, so this
+// driver includes it with its main renamed and calls the catalog directly.
+//
+//   g++ -std=c++17 -O2 -pthread -o planner_tests tests/planner_tests.cpp && ./planner_tests
+//
+// Prints one line per failed check and exits non-zero if there was any.
+
+#define main plannerMain
+#include "../KM_Enhancement2.cpp"
+#undef main
+
+static size_t failures = 0;
+
+#define CHECK(cond) \
+    do { if (!(cond)) { ++failures; cout << __FILE__ << ':' << __LINE__ << ": " << #cond << '\n'; } } while (0)
+
+// for the randomized checks: stops the test at the first failure and names the seed
+#define REQUIRE(cond, seed) \
+    do { if (!(cond)) { ++failures; cout << __FILE__ << ':' << __LINE__ << ": " << #cond << " (seed " << (seed) << ")\n"; return; } } while (0)
+
+// reach[v][u]: u is a prerequisite of v, directly or not (plain BFS from every vertex)
+static vector<vector<char>> bruteReach(const CsrGraph& g) {
+    const uint32_t n = g.nodes();
+    vector<vector<char>> reach(n, vector<char>(n, 0));
+    for (uint32_t v = 0; v < n; ++v) {
+        vector<uint32_t> queue;
+        for (uint32_t p : g.out(v)) if (!reach[v][p]) { reach[v][p] = 1; queue.push_back(p); }
+        for (size_t h = 0; h < queue.size(); ++h)
+            for (uint32_t p : g.out(queue[h])) if (!reach[v][p]) { reach[v][p] = 1; queue.push_back(p); }
+    }
+    return reach;
+}
+
+// writes a scratch file next to the other temporaries and returns its path
+static string scratchFile(const string& name, const string& text) {
+    string path = (filesystem::temp_directory_path() / ("planner_tests_" + name)).string();
+    ofstream(path, ios::binary) << text;
+    return path;
+}
+
+// a synthetic catalog from the --generate writer
+static string generatedFile(const string& name, const GenConfig& cfg) {
+    ostringstream out;
+    generateCatalog(cfg, out);
+    return scratchFile(name, out.str());
+}
+
+template <class Catalog>
+static void loadQuiet(Catalog& cat, const string& path) {
+    cat.quiet = true;
+    cat.sourceFile = path;
+    cat.loadAll(path);
+}
+
+// load instrumentation
+
+// The array and nothrow forms go through the same counter (and malloc) as plain new.
+static void testEveryNewIsCounted() {
+    allocRecorders.fetch_add(1);
+    const uint64_t before = allocTotal.load();
+    int* a = new int[4];
+    int* b = new (nothrow) int;
+    int* c = new (nothrow) int[4];
+    doNotOptimize(a); doNotOptimize(b); doNotOptimize(c);
+    delete[] a;
+    delete b;
+    delete[] c;
+    const uint64_t counted = allocTotal.load() - before;
+    allocRecorders.fetch_sub(1);
+    CHECK(counted == 3);
+}
+
+// synthetic catalogs
+
+// A seed and its options give the same bytes every time (and this exact small file, so a
+// change to the stream of random draws shows up here), and the file holds exactly the
+// malformed rows, missing prerequisites and cycle-closing edges that were asked for.
+static void testGeneratorIsDeterministic() {
+    GenConfig tiny;
+    tiny.courses = 6;
+    tiny.maxPrereqs = 2;
+    tiny.layers = 3;
+    tiny.order = "sorted";
+    tiny.cycles = 1;
+    tiny.missing = 1;
+    tiny.malformed = 2;
+    ostringstream golden;
+    CHECK(generateCatalog(tiny, golden));
+    CHECK(golden.str() == "AAAA0000,Theory Design 100\nAAAA0001,Machine Discrete 101\n,Untitled Row\n"
+        "AAAA0002,Theory Software Machine Systems 102,AAAA0004\nAAAA0002X\n"
+        "AAAA0003,Introduction Applied Databases Machine 103,AAAA0002\n"
+        "AAAA0004,Graphics Mathematics Mathematics 104,AAAA0003,AAAA0001\n"
+        "AAAA0005,Operating Applied Methods 105,AAAA0000,MISSING0\n");
+
+    for (uint64_t seed = 1; seed <= 5; ++seed) {
+        GenConfig cfg;
+        cfg.courses = 2000;
+        cfg.order = seed % 2 ? "random" : "reverse";
+        cfg.cycles = 4 * seed;
+        cfg.missing = 7 * seed;
+        cfg.malformed = 5 * seed;
+        cfg.seed = seed;
+        ostringstream a, b, other;
+        generateCatalog(cfg, a);
+        generateCatalog(cfg, b);
+        REQUIRE(a.str() == b.str(), seed);
+        GenConfig next = cfg;
+        next.seed = seed + 100;
+        generateCatalog(next, other);
+        REQUIRE(a.str() != other.str(), seed);
+
+        CourseCatalog cat;
+        loadQuiet(cat, scratchFile("gen.csv", a.str()));
+        REQUIRE(cat.courses.size() == cfg.courses, seed);
+        REQUIRE(cat.malformedRows.size() == cfg.malformed, seed);
+        REQUIRE(cat.missingPrereqs.size() == cfg.missing, seed);
+
+        // Without cycles the same seed draws the same prerequisites (cycles come after
+        // them), so the extra edges are the cycle-closing ones: exactly cfg.cycles, and
+        // each makes a course require one of its own dependents.
+        GenConfig acyclic = cfg;
+        acyclic.cycles = 0;
+        acyclic.missing = acyclic.malformed = 0;
+        acyclic.order = "sorted";
+        CourseCatalog dag;
+        loadQuiet(dag, generatedFile("gen_dag.csv", acyclic));
+        REQUIRE(!dag.hasCycle() && cat.hasCycle(), seed);
+        size_t extra = 0;
+        for (const Course& c : cat.courses) {
+            const Course* d = dag.find(c.courseNumber());
+            REQUIRE(d != nullptr, seed);
+            vector<string_view> had;
+            for (uint32_t p : d->prerequisites()) had.push_back(dag.codeOf(p));
+            for (uint32_t p : c.prerequisites()) {
+                string_view code = cat.codeOf(p);
+                if (!cat.isCourse(p) || find(had.begin(), had.end(), code) != had.end()) continue;
+                ++extra;
+                auto below = dag.allPrereqs(dag.find(code)->id).ids;  // code needs c in the DAG
+                REQUIRE(find(below.begin(), below.end(), d->id) != below.end(), seed);
+            }
+        }
+        REQUIRE(extra == cfg.cycles, seed);
+    }
+}
+
+// csv parsing
+
+// The mapped tokenizer, serially and split into chunks on a pool, against the original
+// stream parser: same rows in the same order, same diagnostics with the same line numbers.
+// Generated files with malformed rows, plus blank and whitespace-only lines and a last
+// line with no newline; tiny chunk sizes put chunk boundaries all through the file.
+static void testParsersAgree() {
+    ThreadPool pool(4);
+    for (uint64_t seed = 1; seed <= 6; ++seed) {
+        GenConfig cfg;
+        cfg.courses = 400;
+        cfg.malformed = 25;
+        cfg.missing = 10;
+        cfg.cycles = 3;
+        cfg.seed = seed;
+        ostringstream gen;
+        generateCatalog(cfg, gen);
+        string text;
+        size_t lines = 0;
+        forEachLine(gen.str(), [&](string_view line) {
+            text.append(line.data(), line.size()) += '\n';
+            if (++lines % (7 + seed) == 0) text += seed % 2 ? "\n" : "   \n";
+            });
+        text += "ZZZZ9999,Last Row,AAAA0000";                         // no newline at the end
+
+        istringstream in(text);
+        vector<StreamRow> ref;
+        vector<string> refBad;
+        parseCatalogStream(in, ref, refBad);
+        REQUIRE(refBad.size() == cfg.malformed && ref.size() == cfg.courses + 1, seed);
+
+        vector<CsvRow> serial;
+        vector<string> serialBad;
+        parseCatalogText(text, 1, serial, serialBad);
+        auto same = [&](const vector<CsvRow>& rows, const vector<string>& bad) {
+            if (rows.size() != ref.size() || bad != refBad) return false;
+            for (size_t i = 0; i < rows.size(); ++i) {
+                vector<string> prereqs;
+                forEachField(rows[i].prereqs, [&](string_view p) { prereqs.push_back(upperCopy(p)); });
+                if (upperCopy(rows[i].number) != ref[i].courseNumber || rows[i].title != ref[i].courseTitle
+                    || prereqs != ref[i].prerequisites || rows[i].line != serial[i].line) return false;
+            }
+            return true;
+            };
+        REQUIRE(same(serial, serialBad), seed);
+        REQUIRE(serial.back().line == lines + lines / (7 + seed) + 1, seed);
+
+        for (size_t minChunk : { (size_t)1, (size_t)37, (size_t)512, text.size() / 3 }) {
+            vector<CsvRow> rows;
+            vector<string> bad;
+            parseCatalogParallel(text, pool, rows, bad, minChunk);
+            REQUIRE(same(rows, bad), seed);
+        }
+    }
+}
+
+// search trees
+
+// Insert, search and remove share one case-insensitive order: courses inserted in random
+// order and removed by lower-case keys leave a tree that finds exactly the rest.
+template <class Tree>
+static void checkTreeOrder(const CourseCatalog& cat, uint64_t seed) {
+    mt19937_64 rng(seed);
+    vector<uint32_t> ids;
+    for (const Course& c : cat.courses) ids.push_back(c.id);
+    for (size_t i = ids.size() - 1; i > 0; --i) swap(ids[i], ids[rng() % (i + 1)]);
+    Tree tree;
+    for (uint32_t id : ids) tree.insert(cat.courses[id]);
+    auto lower = [](string_view code) { string s(code); for (char& ch : s) ch = (char)tolower((unsigned char)ch); return s; };
+    vector<char> gone(cat.courses.size(), 0);
+    for (size_t i = 0; i < ids.size() / 2; ++i) {
+        REQUIRE(tree.remove(lower(cat.courses[ids[i]].courseNumber())), seed);
+        gone[ids[i]] = 1;
+    }
+    REQUIRE(!tree.remove(lower(cat.courses[ids[0]].courseNumber())), seed);
+    for (const Course& c : cat.courses) {
+        const Course* hit = tree.search(lower(c.courseNumber()));
+        REQUIRE(gone[c.id] ? hit == nullptr : hit == &c, seed);
+    }
+}
+
+static void testTreesFoldCase() {
+    for (uint64_t seed = 1; seed <= 4; ++seed) {
+        GenConfig cfg;
+        cfg.courses = 1500;
+        cfg.seed = seed;
+        CourseCatalog cat;
+        loadQuiet(cat, generatedFile("trees.csv", cfg));
+        checkTreeOrder<BinarySearchTree>(cat, seed);
+        checkTreeOrder<AVLTree>(cat, seed);
+    }
+    CourseCatalog cat;
+    loadQuiet(cat, scratchFile("trees_order.csv", "MATH201,Discrete\nCSCI300,Algorithms\nCSCI200,Data Structures\nART100,Drawing\n"));
+    BinarySearchTree bst;
+    for (const Course& c : cat.courses) bst.insert(c);
+    CHECK(bst.remove("csci200"));
+    string listed;
+    bst.forEachInOrder([&](const Course& c) { listed += c.courseNumber(); listed += ' '; });
+    CHECK(listed == "ART100 CSCI300 MATH201 ");
+}
+
+// static index
+
+// An 8-char query packs to the same key as every longer code that starts with it.
+static void testStaticIndexPrefixKeys() {
+    string csv = scratchFile("prefix.csv",
+        "BIOL1010L,Biology Lab\nCSCI3000LAB,Systems Lab\nCSCI100,Introduction to Computer Science\n");
+    string snap = scratchFile("prefix.snap", "");
+
+    CourseCatalog all;
+    loadQuiet(all, csv);
+    CHECK(all.findStatic("BIOL1010") == nullptr);
+    CHECK(all.findStatic("csci3000") == nullptr);
+    CHECK(all.findHash("BIOL1010") == nullptr);
+    CHECK(all.findStatic("biol1010l") == all.findHash("BIOL1010L"));
+    CHECK(all.findStatic("CSCI3000LAB") != nullptr);
+    CHECK(all.findStatic("CSCI100") != nullptr);
+    CHECK(all.saveSnapshot(snap));
+
+    BasicCourseCatalog<StaticIndex> fixed;
+    loadQuiet(fixed, csv);
+    CHECK(fixed.find("BIOL1010") == nullptr);
+    CHECK(fixed.find("BIOL1010L") != nullptr);
+
+    CourseCatalog mapped;                               // find() goes to the static index here
+    mapped.quiet = true;
+    mapped.sourceFile = csv;
+    string why;
+    CHECK(mapped.loadSnapshot(snap, why));
+    CHECK(mapped.find("csci3000") == nullptr);
+    CHECK(mapped.find("csci3000lab") != nullptr);
+
+    // the exact 8-char code sorts first among the codes sharing its key
+    string both = scratchFile("prefix2.csv", "BIOL1010L,Biology Lab\nBIOL1010,Biology\nBIOL10100,Biology Seminar\n");
+    BasicCourseCatalog<StaticIndex> shared;
+    loadQuiet(shared, both);
+    const Course* c = shared.find("biol1010");
+    CHECK(c && c->courseTitle() == "Biology");
+    c = shared.find("BIOL10100");
+    CHECK(c && c->courseTitle() == "Biology Seminar");
+}
+
+// snapshots
+
+// A snapshot whose checksum is right but whose offsets or ids are not (a buggy or older
+// writer) is refused instead of read out of bounds.
+static void testSnapshotRangeChecks() {
+    string csv = scratchFile("ranges.csv",
+        "CSCI100,Intro\nCSCI200,Data Structures,CSCI100,MATH101\nCSCI300,Algorithms,CSCI200,CSCI100\nMATH201,Discrete,MISSING1\n");
+    string snap = scratchFile("ranges.snap", "");
+    CourseCatalog source;
+    loadQuiet(source, csv);
+    CHECK(source.saveSnapshot(snap));
+    ifstream in(snap, ios::binary);
+    const string good((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    SnapshotHeader h;
+    memcpy(&h, good.data(), sizeof h);
+
+    // rewrites one value of a section, re-signs the file and tries to map it
+    auto mapPatched = [&](SnapSection s, size_t index, auto value, string& why) {
+        string bytes = good;
+        memcpy(&bytes[h.section[s][0] + index * sizeof value], &value, sizeof value);
+        SnapshotHeader patched = h;
+        patched.checksum = snapshotChecksum(bytes.data() + sizeof h, bytes.size() - sizeof h);
+        memcpy(&bytes[0], &patched, sizeof patched);
+        string path = scratchFile("patched.snap", bytes);
+        CourseCatalog cat;
+        cat.quiet = true;
+        cat.sourceFile = csv;
+        return cat.loadSnapshot(path, why);
+        };
+    string why;
+    CHECK(mapPatched(SEC_BY_CODE, 0, uint32_t(0), why));                // same order, still valid
+    const uint32_t bad = h.codeCount + 7;
+    CHECK(!mapPatched(SEC_PREREQ_IDS, 0, bad, why) && why == "offsets or ids out of range");
+    CHECK(!mapPatched(SEC_GRAPH_TARGETS, 0, bad, why) && why == "offsets or ids out of range");
+    CHECK(!mapPatched(SEC_RGRAPH_TARGETS, 1, bad, why) && why == "offsets or ids out of range");
+    CHECK(!mapPatched(SEC_BY_CODE, 2, bad, why) && why == "offsets or ids out of range");
+    CHECK(!mapPatched(SEC_EYT_RANK, 1, bad, why) && why == "offsets or ids out of range");
+    CHECK(!mapPatched(SEC_MISSING, 1, bad, why) && why == "offsets or ids out of range");
+    CHECK(!mapPatched(SEC_CODE_OFFS, 1, uint64_t(1) << 40, why));
+    CHECK(!mapPatched(SEC_CODE_OFFS, 2, uint64_t(0), why) && why == "offsets or ids out of range");
+    CHECK(!mapPatched(SEC_PREREQ_OFFS, 1, uint32_t(3), why) && why == "offsets or ids out of range");
+
+    // a section two bytes short of whole ids; the body is untouched, so the checksum still holds
+    auto mapShortened = [&](SnapSection s, string& why) {
+        string bytes = good;
+        SnapshotHeader patched = h;
+        patched.section[s][1] -= 2;
+        memcpy(&bytes[0], &patched, sizeof patched);
+        string path = scratchFile("shortened.snap", bytes);
+        CourseCatalog cat;
+        cat.quiet = true;
+        cat.sourceFile = csv;
+        return cat.loadSnapshot(path, why);
+        };
+    CHECK(!mapShortened(SEC_MISSING, why) && why == "inconsistent sections");
+    CHECK(!mapShortened(SEC_PREREQ_IDS, why) && why == "inconsistent sections");
+    CHECK(!mapShortened(SEC_GRAPH_TARGETS, why) && why == "inconsistent sections");
+    CHECK(!mapShortened(SEC_RGRAPH_TARGETS, why) && why == "inconsistent sections");
+}
+
+// A quiet catalog says nothing on cout while it falls back to the CSV, rewrites the
+// snapshot or maps it; the background reload and the batch mode rely on that.
+static void testQuietSnapshotLoad() {
+    string csv = scratchFile("quiet.csv", "CSCI100,Intro\nCSCI200,Data Structures,CSCI100\n");
+    string snap = scratchFile("quiet.snap", "");
+    filesystem::remove(snap);
+    ostringstream said;
+    streambuf* saved = cout.rdbuf(said.rdbuf());
+    CourseCatalog first, second;
+    for (CourseCatalog* cat : { &first, &second }) {
+        cat->quiet = true;
+        cat->sourceFile = csv;
+        cat->snapshotPath = snap;
+    }
+    bool loadedCsv = first.loadAll(), mapped = second.loadAll();
+    cout.rdbuf(saved);
+    CHECK(loadedCsv && mapped);
+    CHECK(second.snapshotFile != nullptr);              // the second load came from the snapshot
+    CHECK(said.str().empty());
+}
+
+// hot reload and readers
+
+// A reload publishes a new catalog while a reader still holds the old one: what the reader
+// and a held snapshot return stays as loaded until the reader refreshes, which it does on
+// its next query. A failed reload keeps the published version; each reload reports its
+// own load time.
+static void testReloadWhileReading() {
+    string csv = scratchFile("live.csv", "CSCI100,Intro\nCSCI200,Data Structures,CSCI100\n");
+    LiveCatalog live(csv, 1);
+    string why;
+    double ms = -1;
+    CHECK(live.reload(why, &ms) && ms >= 0 && live.version() == 1);
+    CatalogReader reader(live);
+    const Course* held = reader.find("CSCI100");
+    CHECK(held && held->courseTitle() == "Intro" && reader.version() == 1);
+    LiveCatalog::Snapshot old = live.current();
+
+    scratchFile("live.csv", "CSCI100,Introduction to Computing\nCSCI200,Data Structures,CSCI100\nCSCI300,Algorithms,CSCI200\n");
+    ms = -1;
+    CHECK(live.reload(why, &ms) && ms >= 0 && live.version() == 2);
+    CHECK(live.current() != old);
+    CHECK(held->courseTitle() == "Intro" && reader.version() == 1);     // not refreshed yet
+    CHECK(old->courses.size() == 2 && old->findHash("CSCI300") == nullptr);
+    CHECK(old->findHash("CSCI100")->courseTitle() == "Intro");
+
+    const Course* now = reader.find("CSCI300");                        // refreshes
+    CHECK(now && reader.version() == 2);
+    CHECK(reader.find("CSCI100")->courseTitle() == "Introduction to Computing");
+    CHECK(now && reader.allPrereqs(now->id).ids.size() == 2);
+    CHECK(old->findHash("CSCI100")->courseTitle() == "Intro");          // the held snapshot is untouched
+
+    scratchFile("live.csv", "");
+    CHECK(!live.reload(why) && live.version() == 2 && reader.find("CSCI300") != nullptr);
+
+    // two reloads at once both publish, and each gets a time of its own
+    scratchFile("live.csv", "CSCI100,Intro\n");
+    double first = -1, second = -1;
+    bool ok1 = false, ok2 = false;
+    thread other([&] { string w; ok2 = live.reload(w, &second); });
+    ok1 = live.reload(why, &first);
+    other.join();
+    CHECK(ok1 && ok2 && first >= 0 && second >= 0 && live.version() == 4);
+    CHECK(reader.find("CSCI300") == nullptr && reader.version() == 4);
+}
+
+// prefix and title search
+
+// findPrefix and searchTitles against a scan of every course, on generated catalogs, for
+// number prefixes of every length in either case and for one to three title words, some
+// of them "word*" prefixes, plus words and prefixes that match nothing.
+static void testSearchAgainstBruteForce() {
+    auto lower = [](string s) { for (char& ch : s) ch = (char)tolower((unsigned char)ch); return s; };
+    for (uint64_t seed = 1; seed <= 4; ++seed) {
+        GenConfig cfg;
+        cfg.courses = 3000;
+        cfg.seed = seed;
+        CourseCatalog cat;
+        loadQuiet(cat, generatedFile("search.csv", cfg));
+        mt19937_64 rng(seed);
+        vector<vector<string>> words(cat.courses.size());          // title tokens per course
+        vector<string> vocabulary;
+        string buf;
+        for (const Course& c : cat.courses)
+            forEachToken(c.courseTitle(), buf, [&](string_view w) { words[c.id].emplace_back(w); vocabulary.emplace_back(w); });
+        vocabulary.push_back("nosuchword");
+
+        for (int q = 0; q < 200; ++q) {
+            string code(cat.courses[rng() % cat.courses.size()].courseNumber());
+            string prefix = code.substr(0, rng() % (code.size() + 1));
+            if (q % 2) prefix = lower(prefix);
+            if (q % 17 == 0) prefix += "Q";
+            vector<uint32_t> want;
+            for (const Course& c : cat.courses)
+                if (compareCode(c.courseNumber().substr(0, prefix.size()), prefix) == 0) want.push_back(c.id);
+            IdRange r = cat.findPrefix(prefix);
+            vector<uint32_t> got(r.begin(), r.end());
+            sort(got.begin(), got.end());
+            REQUIRE(got == want, seed);
+
+            string query;
+            vector<pair<string, bool>> terms;
+            for (size_t k = 0, n = 1 + rng() % 3; k < n; ++k) {
+                string w = vocabulary[rng() % vocabulary.size()];
+                bool star = rng() % 3 == 0;
+                if (star) w = w.substr(0, 1 + rng() % w.size());
+                terms.emplace_back(w, star);
+                query += (k ? " " : "") + (q % 2 ? w : string(w).insert(0, 1, ' ')) + (star ? "*" : "");
+            }
+            want.clear();
+            for (const Course& c : cat.courses) {
+                bool all = true;
+                for (const auto& t : terms) {
+                    bool any = false;
+                    for (const string& w : words[c.id]) any |= t.second ? w.compare(0, t.first.size(), t.first) == 0 : w == t.first;
+                    all &= any;
+                }
+                if (all) want.push_back(c.id);
+            }
+            REQUIRE(cat.searchTitles(query) == want, seed);
+        }
+    }
+}
+
+// prefix and search with nothing to look for are error rows, not course lookups
+static void testBatchEmptySearch() {
+    CourseCatalog cat;
+    loadQuiet(cat, scratchFile("emptysearch.csv", "CSCI100,Intro\nPREFIX,Named Like The Verb\n"));
+    ostringstream text, json;
+    CHECK(runBatch(cat, "prefix\nsearch   \nprefix csci\n", BatchFormat::Text, text) == 3);
+    CHECK(text.str() == "prefix: Enter a course number prefix.\n\nsearch: Enter at least one title word.\n\nCSCI100, Intro\n\n");
+    runBatch(cat, "search\n", BatchFormat::Json, json);
+    CHECK(json.str() == "{\"query\":\"search\",\"ok\":false,\"error\":\"search: Enter at least one title word.\",\"courses\":[]}\n");
+}
+
+// batch queries
+
+// eligible and impact answers are listed by course number, like every other listing
+static void testBatchListsByCode() {
+    CourseCatalog cat;
+    loadQuiet(cat, scratchFile("batch.csv",
+        "MATH201,Discrete\nCSCI300,Algorithms,CSCI200,MATH201\nCSCI200,Data Structures,MATH201\nART100,Drawing\nBIOL100,Biology\n"));
+    ostringstream text, json;
+    const string input = "eligible NOPE\neligible math201\nimpact MATH201\n";   // the error row must not leak into the next
+    CHECK(runBatch(cat, input, BatchFormat::Text, text) == 3);
+    CHECK(text.str() == "NOPE: Course not found.\n\nEligible (3): ART100, BIOL100, CSCI200\n\nDownstream (2): CSCI200, CSCI300\n\n");
+    runBatch(cat, input, BatchFormat::Json, json);
+    CHECK(json.str() == "{\"query\":\"eligible NOPE\",\"ok\":false,\"error\":\"NOPE: Course not found.\",\"courses\":[]}\n"
+        "{\"query\":\"eligible math201\",\"ok\":true,\"courses\":[\"ART100\",\"BIOL100\",\"CSCI200\"]}\n"
+        "{\"query\":\"impact MATH201\",\"ok\":true,\"courses\":[\"CSCI200\",\"CSCI300\"]}\n");
+}
+
+// A term cap that is not a number is an error row, not cap 0 (no cap).
+static void testBatchPlanCap() {
+    CourseCatalog cat;
+    loadQuiet(cat, scratchFile("plancap.csv", "CSCI100,Intro\nCSCI200,Data Structures,CSCI100\nMATH101,Calculus\n"));
+    ostringstream text, json;
+    CHECK(runBatch(cat, "plan abc\nplan 2x CSCI200\nplan -1\nplan 1 CSCI200\n", BatchFormat::Text, text) == 4);
+    CHECK(text.str() == "abc: Not a course count (0 means no cap).\n\n2x: Not a course count (0 means no cap).\n\n"
+        "-1: Not a course count (0 means no cap).\n\nPlan: 2 terms, longest chain 2\nTerm 1: CSCI100\nTerm 2: CSCI200\n\n");
+    runBatch(cat, "plan abc\n", BatchFormat::Json, json);
+    CHECK(json.str().find("{\"query\":\"plan abc\",\"ok\":false,\"error\":\"abc: Not a course count (0 means no cap).\"") == 0);
+}
+
+// --batch with a snapshot: stdout carries nothing but the answers, on the run that falls
+// back to the CSV and writes the snapshot and on the run that maps it.
+static void testBatchWithSnapshot() {
+    CourseCatalog config;
+    config.sourceFile = scratchFile("batchsnap.csv", "CSCI100,Intro\nCSCI300,Algorithms,CSCI100\n");
+    config.snapshotPath = scratchFile("batchsnap.snap", "");
+    filesystem::remove(config.snapshotPath);
+    for (int run = 0; run < 2; ++run) {
+        ostringstream out, report;
+        streambuf* saved = cout.rdbuf(out.rdbuf());
+        ServingCatalog serving;
+        bool ok = loadServing(serving, config, report);
+        if (ok) serveBatch(serving, "csci300\nchain CSCI300\n", BatchFormat::Json, cout, report);
+        cout.rdbuf(saved);
+        CHECK(ok);
+        CHECK((serving.snapshotFile != nullptr) == (run == 1));
+        CHECK(out.str() == "{\"query\":\"csci300\",\"found\":true,\"number\":\"CSCI300\",\"title\":\"Algorithms\",\"prerequisites\":[\"CSCI100\"]}\n"
+            "{\"query\":\"chain CSCI300\",\"found\":true,\"number\":\"CSCI300\",\"title\":\"Algorithms\",\"prerequisites\":[\"CSCI100\"],"
+            "\"all_prerequisites\":[\"CSCI100\"],\"depth\":1}\n");
+        CHECK(report.str().find("2 queries in") == 0);
+    }
+}
+
+// transitive prerequisites
+
+// closureOf and depthOf on random graphs (half of them cyclic) against a BFS from every
+// course; a third run with a tiny memo budget so the spill path is covered too.
+static void testClosureAgainstBruteForce() {
+    for (uint32_t seed = 0; seed < 150; ++seed) {
+        mt19937 rng(seed);
+        uint32_t n = 1 + rng() % 120;
+        size_t m = rng() % (n * 3);
+        bool dag = seed % 2;
+        vector<pair<uint32_t, uint32_t>> edges;
+        for (size_t i = 0; i < m; ++i) {
+            uint32_t a = rng() % n, b = rng() % n;
+            if (dag) {
+                if (a == b) continue;
+                if (a < b) swap(a, b);
+            }
+            edges.emplace_back(a, b);                   // course a requires b
+        }
+        CsrGraph g = CsrGraph::build(n, edges);
+        PrereqClosure closure;
+        closure.reset(&g);
+        if (seed % 3 == 0) closure.memoBudget = 64;
+        vector<vector<char>> reach = bruteReach(g);
+
+        // depth: longest chain of prerequisites between cyclic groups (mutual reach)
+        vector<uint32_t> group(n);
+        for (uint32_t v = 0; v < n; ++v) {
+            group[v] = v;
+            for (uint32_t u = 0; u < v; ++u) if (reach[v][u] && reach[u][v]) { group[v] = group[u]; break; }
+        }
+        vector<int> depth(n, -1);
+        function<int(uint32_t)> depthOfGroup = [&](uint32_t gv) {
+            if (depth[gv] >= 0) return depth[gv];
+            int d = 0;
+            for (uint32_t x = 0; x < n; ++x)
+                if (group[x] == gv)
+                    for (uint32_t p : g.out(x)) if (group[p] != gv) d = max(d, depthOfGroup(group[p]) + 1);
+            return depth[gv] = d;
+            };
+
+        vector<uint32_t> order(n);
+        for (uint32_t i = 0; i < n; ++i) order[i] = i;
+        shuffle(order.begin(), order.end(), rng);
+        for (int pass = 0; pass < 2; ++pass)            // second pass answers from the memo
+            for (uint32_t v : order) {
+                const SparseBits& s = closure.closureOf(v);
+                for (uint32_t u = 0; u < n; ++u) REQUIRE(s.test(u) == (bool)reach[v][u], seed);
+                REQUIRE(s.count() == (size_t)count(reach[v].begin(), reach[v].end(), 1), seed);
+                REQUIRE(closure.depthOf(v) == (uint32_t)depthOfGroup(group[v]), seed);
+            }
+    }
+}
+
+// edits
+
+// A prerequisite that is not there is reported without interning the code that was typed.
+static void testDropUnknownPrereq() {
+    CourseCatalog cat;
+    loadQuiet(cat, scratchFile("drop.csv", "CSCI100,Intro\nCSCI200,Data Structures,CSCI100\n"));
+    const size_t codes = cat.codes.size();
+    string err;
+    CHECK(!cat.removePrereq("CSCI200", "CSCI10O", err));
+    CHECK(err == "CSCI10O not found");
+    CHECK(!cat.removePrereq("CSCI100", "csci200", err));
+    CHECK(err == "CSCI100 does not require CSCI200");
+    CHECK(!cat.addPrereq("CSCI200", "  ", err));
+    CHECK(err == "empty prerequisite");
+    CHECK(cat.codes.size() == codes);
+    CHECK(cat.removePrereq("csci200", "csci100", err));
+    CHECK(cat.find("CSCI200")->prerequisites().size() == 0);
+    CHECK(cat.addPrereq("CSCI200", "MATH101", err));      // adding still interns a new code
+    CHECK(cat.codes.size() == codes + 1);
+}
+
+// A blank prerequisite is refused by addPrereq and skipped by add/update; none of them
+// interns "" as a code or touches the course's list.
+static void testEmptyPrereqRefused() {
+    CourseCatalog cat;
+    loadQuiet(cat, scratchFile("emptyreq.csv", "CSCI100,Intro\nCSCI200,Data Structures,CSCI100\n"));
+    const size_t codes = cat.codes.size();
+    string err;
+    for (string_view blank : { "", " ", "\t ", "  \t" }) {
+        err.clear();
+        CHECK(!cat.addPrereq("CSCI200", blank, err) && err == "empty prerequisite");
+    }
+    CHECK(cat.codes.size() == codes && cat.codes.find("") == CodeTable::npos);
+    const Course* c = cat.find("CSCI200");
+    CHECK(c && c->prerequisites().size() == 1 && cat.codeOf(c->prerequisites()[0]) == "CSCI100");
+    CHECK(cat.addCourse("CSCI300", "Algorithms", { " ", "CSCI200", "" }, err));
+    CHECK(cat.updateCourse("CSCI200", "Data Structures", { "\t", "csci100" }, err));
+    CHECK(cat.codes.size() == codes + 1 && cat.codes.find("") == CodeTable::npos);
+    CHECK(cat.find("CSCI300")->prerequisites().size() == 1 && cat.find("CSCI200")->prerequisites().size() == 1);
+    CHECK(!cat.hasCycle() && cat.missingPrereqs.empty());
+}
+
+// The benchmark suite loads its own catalog: the edits in the one it is handed stay, and
+// so does a catalog mapped from a snapshot (still mapped, same data, source untouched).
+static void testBenchmarkKeepsEdits() {
+    CourseCatalog cat;
+    loadQuiet(cat, scratchFile("bench.csv", "CSCI100,Intro\nCSCI200,Data Structures,CSCI100\n"));
+    string err;
+    CHECK(cat.addCourse("CSCI300", "Algorithms", { "CSCI200" }, err));
+    CHECK(cat.removePrereq("CSCI200", "CSCI100", err));
+    BenchConfig cfg;
+    cfg.ops = 100;
+    cfg.reps = 1;
+    ostringstream json;
+    CHECK(runBenchmarkSuite(cat, cfg, &json));
+    CHECK(json.str().find("\"courses\": 2,") != string::npos);
+    const Course* c = cat.find("CSCI300");
+    CHECK(c && c->courseTitle() == "Algorithms");
+    c = cat.find("CSCI200");
+    CHECK(c && c->prerequisites().size() == 0);
+    CHECK(cat.courseCount() == 3);
+
+    string snap = scratchFile("bench.snap", "");
+    filesystem::remove(snap);
+    CourseCatalog source, mapped;
+    loadQuiet(source, cat.sourceFile);
+    CHECK(source.saveSnapshot(snap));
+    mapped.quiet = true;
+    mapped.sourceFile = cat.sourceFile;
+    mapped.snapshotPath = snap;
+    CHECK(mapped.loadAll() && mapped.snapshotFile != nullptr);
+    const Course* before = mapped.find("CSCI200");
+    ostringstream again;
+    CHECK(runBenchmarkSuite(mapped, cfg, &again));
+    CHECK(mapped.snapshotFile != nullptr && mapped.find("CSCI200") == before);
+    CHECK(before && before->courseTitle() == "Data Structures" && mapped.courseCount() == 2);
+}
+
+// Random edit scripts (add, update, remove, require, drop; cycle-closing ones included)
+// on small catalogs, some with a cycle and missing prerequisites from the CSV. After
+// every edit the graph, missing list, cycle flag, topological order and all lookups are
+// checked against the course records themselves, and an acyclic catalog must stay so.
+static void testEditsAgainstBruteForce() {
+    auto code = [](uint32_t i) { char b[16]; snprintf(b, sizeof b, "C%03u", i); return string(b); };
+    for (uint32_t seed = 0; seed < 150; ++seed) {
+        mt19937 rng(seed);
+        uint32_t n = 5 + rng() % 40;
+        const bool cyclic = seed % 4 == 3;
+        string csv;
+        for (uint32_t i = 0; i < n; ++i) {
+            csv += code(i) + ",Title " + to_string(i);
+            for (uint32_t k = rng() % 3, j = 0; j < k && i > 0; ++j) csv += "," + code(rng() % i);
+            if (rng() % 10 == 0) csv += ",Z" + to_string(rng() % 5);
+            csv += '\n';
+        }
+        if (cyclic) csv += code(n) + ",Loop," + code(n + 1) + "\n" + code(n + 1) + ",Loop," + code(n) + "\n";
+        CourseCatalog cat;
+        loadQuiet(cat, scratchFile("edits.csv", csv));
+
+        auto randomList = [&] {
+            vector<string> list;
+            for (uint32_t k = rng() % 3, j = 0; j < k; ++j) list.push_back(code(rng() % (n + 8)));
+            return list;
+            };
+        for (int step = 0; step < 120; ++step) {
+            string err, a = code(rng() % (n + 8)), b = code(rng() % (n + 8));
+            const bool wasAcyclic = !cyclic && !cat.hasCycle();
+            switch (rng() % 6) {
+            case 0: {
+                vector<string> list = randomList();
+                cat.addCourse(a, "New " + a, vector<string_view>(list.begin(), list.end()), err);
+                break;
+            }
+            case 1: cat.removeCourse(a, err); break;
+            case 2: case 3: cat.addPrereq(a, b, err); break;
+            case 4: cat.removePrereq(a, b, err); break;
+            default: {
+                vector<string> list = randomList();
+                cat.updateCourse(a, "Updated", vector<string_view>(list.begin(), list.end()), err);
+            }
+            }
+
+            vector<pair<uint32_t, uint32_t>> wantEdges, wantMissing, gotEdges;   // compared sorted
+            size_t live = 0;
+            for (const Course& c : cat.courses) {
+                if (c.removed) continue;
+                ++live;
+                for (uint32_t p : c.prerequisites()) {
+                    if (cat.isCourse(p)) wantEdges.push_back({ p, c.id });
+                    else wantMissing.push_back({ c.id, p });
+                }
+            }
+            bool ordered = false;
+            vector<uint32_t> order = cat.topoOrder(ordered);
+            const bool flagged = cat.hasCycle();
+            cat.syncGraph();
+            for (uint32_t u = 0; u < cat.graph.nodes(); ++u)
+                for (uint32_t v : cat.graph.out(u)) gotEdges.push_back({ u, v });
+            vector<pair<uint32_t, uint32_t>> gotMissing = cat.missingPrereqs;
+            for (auto* list : { &wantEdges, &wantMissing, &gotEdges, &gotMissing }) sort(list->begin(), list->end());
+            REQUIRE(gotEdges == wantEdges, seed);
+            REQUIRE(gotMissing == wantMissing, seed);
+            const bool cycle = csrHasCycle(cat.graph);
+            REQUIRE(flagged == cycle, seed);
+            REQUIRE(!(wasAcyclic && cycle), seed);       // an edit that closes a cycle is refused
+            if (!cycle) {
+                REQUIRE(ordered && order.size() == live, seed);
+                vector<size_t> pos(cat.courses.size());
+                for (size_t i = 0; i < order.size(); ++i) pos[order[i]] = i;
+                for (const auto& e : wantEdges) REQUIRE(pos[e.first] < pos[e.second], seed);
+            }
+            REQUIRE(cat.courseCount() == live && cat.hmap.size() == live, seed);
+            for (uint32_t i = 0; i < n + 8; ++i) {
+                string k = code(i);
+                const Course* c = cat.findHash(k);
+                REQUIRE(c == cat.findBST(k) && c == cat.findAVL(k) && c == cat.find(k) && c == cat.findVector(k), seed);
+                REQUIRE(!c || (!c->removed && c->courseNumber() == k), seed);
+            }
+        }
+    }
+}
+
+// semester planning
+
+// With no course released (an empty catalog, or one that is all cycle) there is no chain:
+// criticalPath is empty and the batch says so instead of listing nothing.
+static void testCriticalPathWithoutLevels() {
+    const pair<const char*, const char*> cases[] = {
+        { "critical_empty.csv", "" },
+        { "critical_cycle.csv", "CSCI100,Intro,CSCI200\nCSCI200,Data Structures,CSCI100\n" },
+    };
+    for (const auto& k : cases) {
+        CourseCatalog cat;
+        loadQuiet(cat, scratchFile(k.first, k.second));
+        CHECK(cat.courseLevels().levels() == 0);
+        CHECK(cat.criticalPath().empty());
+        ostringstream text, json;
+        runBatch(cat, "critical\n", BatchFormat::Text, text);
+        CHECK(text.str() == "No acyclic prerequisite chain (every course is on or behind a cycle).\n\n");
+        runBatch(cat, "critical\n", BatchFormat::Json, json);
+        CHECK(json.str() == "{\"query\":\"critical\",\"courses\":[]}\n");
+    }
+}
+
+// eligibility
+
+// EligibilityEngine against a per-course scan, for batch sizes around the word and lane
+// boundaries, on generated catalogs with cycles and missing prerequisites, before and
+// after edits (which rebuild the engine).
+static void testEligibilityAgainstBruteForce() {
+    for (uint32_t seed = 1; seed <= 6; ++seed) {
+        GenConfig cfg;
+        cfg.courses = 500 + seed * 400;
+        cfg.maxPrereqs = 2 + seed % 4;
+        cfg.cycles = seed % 2 ? 20 : 0;
+        cfg.missing = 30;
+        cfg.seed = seed;
+        CourseCatalog cat;
+        loadQuiet(cat, generatedFile("eligible.csv", cfg));
+        mt19937 rng(seed);
+        for (int round = 0; round < 2; ++round) {
+            const uint32_t codes = (uint32_t)cat.codes.size(), n = (uint32_t)cat.courses.size();
+            for (size_t batch : { 1, 63, 64, 65, 256, 257, 300 }) {
+                vector<vector<uint32_t>> transcripts(batch);
+                for (auto& t : transcripts) {
+                    uint32_t c = rng() % n;                    // a course's whole chain, maybe the course too
+                    for (uint32_t p : cat.allPrereqs(c).ids) t.push_back(p);
+                    if (rng() % 2) t.push_back(c);
+                    for (uint32_t k = rng() % 5; k > 0; --k) t.push_back(rng() % codes);
+                }
+                vector<vector<uint32_t>> got(batch);
+                size_t miscounted = 0;
+                cat.eligibility().run(transcripts, [&](size_t i, const EligibilityEngine::Courses& ids) {
+                    ids.forEach([&](uint32_t id) { got[i].push_back(id); });
+                    miscounted += ids.size() != got[i].size();
+                    });
+                REQUIRE(miscounted == 0, seed);
+                vector<char> done(codes);
+                for (size_t i = 0; i < batch; ++i) {
+                    for (uint32_t id : transcripts[i]) done[id] = 1;
+                    vector<uint32_t> want;
+                    for (const Course& c : cat.courses) {
+                        if (c.removed || done[c.id]) continue;
+                        bool ready = true;
+                        for (uint32_t p : c.prerequisites()) if (!done[p]) { ready = false; break; }
+                        if (ready) want.push_back(c.id);
+                    }
+                    for (uint32_t id : transcripts[i]) done[id] = 0;
+                    REQUIRE(got[i] == want, seed);
+                    REQUIRE(cat.eligibility().eligible(transcripts[i]) == want, seed);
+                }
+            }
+            // edits drop the engine; the second round checks the rebuilt one
+            string err;
+            for (int k = 0; k < 20; ++k) {
+                string a(cat.codeOf(rng() % n)), b(cat.codeOf(rng() % n));
+                if (k % 3 == 0) cat.removeCourse(a, err);
+                else cat.addPrereq(a, b, err);
+            }
+            cat.addCourse("NEW100", "New Course", { cat.codeOf(0), "NOSUCH1" }, err);
+        }
+    }
+}
+
+// downstream impact
+
+// impact() in every direction mode against a plain BFS per query, for batch sizes around
+// the lane count, on acyclic and cyclic generated catalogs, before and after edits.
+static void testImpactAgainstBruteForce() {
+    for (uint32_t seed = 1; seed <= 6; ++seed) {
+        GenConfig cfg;
+        cfg.courses = 800 + seed * 500;
+        cfg.layers = seed % 3 ? 12 : 60;
+        cfg.cycles = seed % 2 ? 15 : 0;
+        cfg.missing = 20;
+        cfg.seed = seed;
+        CourseCatalog cat;
+        loadQuiet(cat, generatedFile("impact.csv", cfg));
+        mt19937 rng(seed);
+        for (int round = 0; round < 2; ++round) {
+            cat.syncGraph();
+            const uint32_t n = cat.graph.nodes();
+            for (size_t batch : { 1, 64, 65, 200 }) {
+                vector<vector<uint32_t>> queries(batch);
+                for (auto& q : queries) for (uint32_t k = 1 + rng() % 3; k > 0; --k) q.push_back(rng() % n);
+                vector<vector<uint32_t>> want(batch);
+                vector<char> seen(n);
+                for (size_t i = 0; i < batch; ++i) {
+                    vector<uint32_t> queue;
+                    for (uint32_t s : queries[i]) if (!seen[s]) { seen[s] = 1; queue.push_back(s); }
+                    for (size_t h = 0; h < queue.size(); ++h)
+                        for (uint32_t w : cat.graph.out(queue[h])) if (!seen[w]) { seen[w] = 1; queue.push_back(w); }
+                    for (uint32_t s : queries[i]) seen[s] = 0;  // sources are not their own impact
+                    for (uint32_t v = 0; v < n; ++v) if (seen[v]) want[i].push_back(v);
+                    fill(seen.begin(), seen.end(), 0);
+                }
+                for (BfsMode mode : { BfsMode::TopDown, BfsMode::BottomUp, BfsMode::Auto }) {
+                    size_t answered = 0, wrong = 0;
+                    cat.impact(queries, [&](size_t i, IdRange ids) {
+                        ++answered;
+                        wrong += vector<uint32_t>(ids.begin(), ids.end()) != want[i];
+                        }, mode);
+                    REQUIRE(answered == batch && wrong == 0, seed);
+                }
+            }
+            string err;
+            for (int k = 0; k < 20; ++k) {
+                string a(cat.codeOf(rng() % n)), b(cat.codeOf(rng() % n));
+                if (k % 4 == 0) cat.removeCourse(a, err);
+                else cat.addPrereq(a, b, err);
+            }
+        }
+    }
+}
+
+int main() {
+    testEveryNewIsCounted();
+    testGeneratorIsDeterministic();
+    testParsersAgree();
+    testTreesFoldCase();
+    testStaticIndexPrefixKeys();
+    testClosureAgainstBruteForce();
+    testSnapshotRangeChecks();
+    testQuietSnapshotLoad();
+    testReloadWhileReading();
+    testSearchAgainstBruteForce();
+    testBatchEmptySearch();
+    testBatchListsByCode();
+    testBatchPlanCap();
+    testBatchWithSnapshot();
+    testDropUnknownPrereq();
+    testEmptyPrereqRefused();
+    testBenchmarkKeepsEdits();
+    testEditsAgainstBruteForce();
+    testCriticalPathWithoutLevels();
+    testEligibilityAgainstBruteForce();
+    testImpactAgainstBruteForce();
+    if (failures) { cout << failures << " check(s) failed\n"; return 1; }
+    cout << "all checks passed\n";
+    return 0;
+}